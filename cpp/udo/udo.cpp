@@ -53,3 +53,117 @@ uint8_t udo_calc_crc(uint8_t acrc, uint8_t adata)
   uint8_t idx = (acrc ^ adata);
   return udo_crc_table[idx];
 }
+
+#if UDO_CRC_SLICING
+
+static uint8_t udo_crc_slice_table[8][256];  // [k][x]: the CRC of x followed by k zero bytes
+
+static bool udo_crc_slice_init()
+{
+  for (unsigned n = 0; n < 256; ++n)
+  {
+    udo_crc_slice_table[0][n] = udo_crc_table[n];
+  }
+
+  for (unsigned k = 1; k < 8; ++k)
+  {
+    for (unsigned n = 0; n < 256; ++n)
+    {
+      udo_crc_slice_table[k][n] = udo_crc_table[udo_crc_slice_table[k - 1][n]];
+    }
+  }
+
+  return true;
+}
+
+uint8_t udo_calc_crc_block(uint8_t acrc, const void * adata, unsigned alen)
+{
+  static const bool tables_ready = udo_crc_slice_init();  // one-time (thread safe) initialization
+  (void)tables_ready;
+
+  const uint8_t * p = (const uint8_t *)adata;
+  const uint8_t * endp = p + alen;
+  uint8_t crc = acrc;
+
+  // the CRC is linear: 8 bytes are processed with independent table lookups
+  while (endp - p >= 8)
+  {
+    crc = udo_crc_slice_table[7][crc ^ p[0]] ^ udo_crc_slice_table[6][p[1]]
+        ^ udo_crc_slice_table[5][p[2]] ^ udo_crc_slice_table[4][p[3]]
+        ^ udo_crc_slice_table[3][p[4]] ^ udo_crc_slice_table[2][p[5]]
+        ^ udo_crc_slice_table[1][p[6]] ^ udo_crc_slice_table[0][p[7]];
+    p += 8;
+  }
+
+  while (p < endp)
+  {
+    crc = udo_crc_table[crc ^ *p++];
+  }
+
+  return crc;
+}
+
+#else
+
+uint8_t udo_calc_crc_block(uint8_t acrc, const void * adata, unsigned alen)
+{
+  const uint8_t * p = (const uint8_t *)adata;
+  const uint8_t * endp = p + alen;
+  uint8_t crc = acrc;
+  while (p < endp)
+  {
+    crc = udo_crc_table[crc ^ *p++];
+  }
+  return crc;
+}
+
+#endif
+
+// CRC32 with 16 entry (nibble) table, small enough for the MCU slaves too
+
+static const uint32_t udo_crc32_table[16] =
+{
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t udo_calc_crc32(uint32_t acrc, const void * adata, unsigned alen)
+{
+  const uint8_t * p = (const uint8_t *)adata;
+  const uint8_t * endp = p + alen;
+  uint32_t crc = ~acrc;
+  while (p < endp)
+  {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ udo_crc32_table[crc & 15];
+    crc = (crc >> 4) ^ udo_crc32_table[crc & 15];
+  }
+  return ~crc;
+}
+
+static uint32_t udo_crc32_multmodp(uint32_t a, uint32_t b)  // a * b modulo the CRC polynom (reflected)
+{
+  uint32_t m = 0x80000000;
+  uint32_t p = 0;
+  while (m)
+  {
+    if (a & m)  p ^= b;
+    m >>= 1;
+    b = (b & 1) ? ((b >> 1) ^ 0xEDB88320) : (b >> 1);
+  }
+  return p;
+}
+
+uint32_t udo_crc32_combine(uint32_t acrc1, uint32_t acrc2, uint32_t alen2)
+{
+  // acrc1 shifted through alen2 zero bytes: multiplied by x^(8 * alen2)
+  uint32_t xp = 0x00800000;  // x^8 (x^0 = 0x80000000 in the reflected form)
+  uint32_t p  = 0x80000000;
+  while (alen2)
+  {
+    if (alen2 & 1)  p = udo_crc32_multmodp(xp, p);
+    xp = udo_crc32_multmodp(xp, xp);
+    alen2 >>= 1;
+  }
+  return udo_crc32_multmodp(p, acrc1) ^ acrc2;
+}
@@ -34,6 +34,14 @@
   #define UDO_MAX_DATALEN    1024
 #endif
 
+#ifndef UDO_CRC_SLICING
+  #if defined(LINUX) || defined(WIN32) || defined(WINDOWS)
+    #define UDO_CRC_SLICING    1  // slicing-by-8 block CRC on the hosted builds (2 kByte tables)
+  #else
+    #define UDO_CRC_SLICING    0
+  #endif
+#endif
+
 #define UDOERR_CONNECTION       0x1001  // not connected, send / receive error
 #define UDOERR_CRC              0x1002
 #define UDOERR_TIMEOUT          0x1003
@@ -67,10 +75,65 @@ typedef struct TUdoRequest
   uint16_t     maxanslen;    // maximal read buffer length
   uint16_t     result;       // 0 if no error
 
-  uint8_t *    dataptr;
+  uint8_t *    dataptr;      // read handlers may redirect it to their own data, the answer is taken from here
 //
 } TUdoRequest;
 
+// Multi-read object (0x0003): reads a list of objects with one request.
+// The list of TUdoMultiReadItem records is written to the object 0x0003, then the read of 0x0003
+// (offset = 0) returns for every item a TUdoMultiReadAnsHead followed by the data padded to 4 bytes.
+// On UDO-IP the list can be appended to the read request too, then the offset holds the item count.
+
+#ifndef UDO_MULTIREAD_MAX_ITEMS
+  #define UDO_MULTIREAD_MAX_ITEMS   32
+#endif
+
+typedef struct TUdoMultiReadItem
+{
+  uint16_t     index;
+  uint16_t     len;          // maximal read length
+  uint32_t     offset;
+//
+} TUdoMultiReadItem;  // 8 bytes
+
+typedef struct TUdoMultiReadAnsHead
+{
+  uint16_t     len;          // answer data length, the data follows
+  uint16_t     result;       // 0 if no error
+//
+} TUdoMultiReadAnsHead;  // 4 bytes
+
+// Object descriptor object (0x0004): read only, the offset holds the index of the object in question,
+// returns an u32 with the UDO_OBJDESC_ bits. UDOERR_WRONG_OFFSET when the slave has no descriptor for it.
+
+#define UDO_OBJDESC_READONLY    0x00000001
+#define UDO_OBJDESC_WRITEONLY   0x00000002
+#define UDO_OBJDESC_CONST       0x00000004  // the value never changes while the device is running, masters may cache it
+
+// Large payload object (0x0005): read only, answered by the UDO-IP transport, returns the maximal data length
+// of the requests with extended length (UDOERR_INDEX when not supported). With extended length the LEN field
+// of the UDO-IP request header is UDOIP_LEN_EXT and an u32 length follows the header, before the request data.
+// The answer header is not extended, the answer data length is given by the datagram length.
+
+#define UDOIP_LEN_EXT           0x7FE
+
+// Blob checksum object (0x0006): read only, returns the u32 CRC32 (udo_calc_crc32()) of an object range,
+// calculated from the data read back from the object. Used to verify the blob (firmware) uploads end-to-end.
+// The range is given in the read request, so it works on every transport: the offset is the start of the range,
+// the metadata holds the object index (bits 0..15) and the range length (bits 16..31).
+// One request checks max. UDO_BLOBCRC_MAX_LEN bytes, the masters combine the CRCs of the longer ranges
+// with udo_crc32_combine().
+
+#define UDO_BLOBCRC_MAX_LEN     32768  // limits the slave side processing time of one request
+
+#define UDO_BLOBCRC_METADATA(aindex, alen)  ((uint32_t)(aindex) | ((uint32_t)(alen) << 16))
+
 uint8_t udo_calc_crc(uint8_t acrc, uint8_t adata);  // used for serial communication
+uint8_t udo_calc_crc_block(uint8_t acrc, const void * adata, unsigned alen);  // same as udo_calc_crc() for every byte
+
+// CRC32 with the polynom of 0xEDB88320 (same as zlib crc32()), start with acrc = 0, can be continued
+uint32_t udo_calc_crc32(uint32_t acrc, const void * adata, unsigned alen);
+// the CRC32 of the concatenated data from the CRC32 of the two parts (acrc2 is calculated over alen2 bytes)
+uint32_t udo_crc32_combine(uint32_t acrc1, uint32_t acrc2, uint32_t alen2);
 
 #endif
@@ -0,0 +1,455 @@
+/*
+ * main_udobench.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: vitya
+ */
+
+// UDO master benchmark: request latency, small object throughput and blob transfer speed
+// using the base objects 0x0000 (comm. test) and 0x0002 (blob test), UDO-IP and UDO-SL
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "nstime.h"
+#include "udo_comm.h"
+#include "commh_udoip.h"
+#include "commh_udosl.h"
+
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#define UDOBENCH_BLOB_SIZE   262144  // size of the blob test object (0x0002)
+#define UDOBENCH_MAX_WINDOW  64
+
+struct TBenchConfig
+{
+  string     devstr;
+  unsigned   samples = 1000;             // latency samples
+  double     duration = 2.0;             // seconds of the ops/s measurement
+  uint32_t   blobsize = UDOBENCH_BLOB_SIZE;
+  unsigned   blobrepeat = 4;
+  unsigned   window = 1;                 // max_inflight
+  unsigned   baudrate = 1000000;         // UDO-SL only
+  unsigned   rqcheck = 0;                // request path overhead check: number of reads, 0 = off
+  bool       json = false;
+};
+
+struct TBenchResult
+{
+  unsigned   lat_samples = 0;
+  double     lat_min = 0, lat_avg = 0, lat_p50 = 0, lat_p99 = 0, lat_p999 = 0, lat_max = 0;  // us
+  double     ops_per_s = 0;
+  double     read_mbps = 0;
+  double     write_mbps = 0;
+  const char * crc_check = "n/a";
+  unsigned   errors = 0;
+  unsigned   verify_errors = 0;
+
+  double     rq_allocs = 0;    // heap allocations / read
+  double     rq_sockopts = 0;  // setsockopt(SO_RCVTIMEO) calls / read, UDO-IP only
+  double     rq_ns = 0;        // ns / read
+};
+
+TBenchConfig  cfg;
+TBenchResult  res;
+
+uint32_t      blobref[UDOBENCH_BLOB_SIZE / 4];  // the content of the blob test object: incrementing words
+uint32_t      blobbuf[UDOBENCH_BLOB_SIZE / 4];
+
+// counts the heap allocations for the request path overhead check
+
+unsigned      heap_alloc_count = 0;
+
+void * operator new(size_t asize)
+{
+  ++heap_alloc_count;
+  void * p = malloc(asize ? asize : 1);
+  if (!p)  throw bad_alloc();
+  return p;
+}
+
+void operator delete(void * p) noexcept            { free(p); }
+void operator delete(void * p, size_t) noexcept    { free(p); }
+
+static double percentile(vector<double> & sorted, double p)  // nearest rank
+{
+  size_t rank = size_t(p * sorted.size() + 0.999999);
+  if (rank < 1)  rank = 1;
+  if (rank > sorted.size())  rank = sorted.size();
+  return sorted[rank - 1];
+}
+
+static double elapsed_s(nstime_t t0)
+{
+  return double(nstime() - t0) / 1000000000.0;
+}
+
+void bench_latency()
+{
+  vector<double>  lat;
+  uint32_t        d32;
+
+  lat.reserve(cfg.samples);
+  for (unsigned n = 0; n < cfg.samples; ++n)
+  {
+    nstime_t t0 = nstime();
+    try
+    {
+      int r = udocomm.UdoRead(0x0000, 0, &d32, 4);
+      if ((r != 4) || (d32 != 0x66CCAA55))
+      {
+        ++res.verify_errors;
+        continue;
+      }
+    }
+    catch (EUdoAbort & e)
+    {
+      ++res.errors;
+      continue;
+    }
+    lat.push_back(double(nstime() - t0) / 1000.0);
+  }
+
+  res.lat_samples = lat.size();
+  if (lat.empty())
+  {
+    return;
+  }
+
+  double sum = 0;
+  for (double v : lat)  sum += v;
+
+  sort(lat.begin(), lat.end());
+  res.lat_min  = lat.front();
+  res.lat_max  = lat.back();
+  res.lat_avg  = sum / lat.size();
+  res.lat_p50  = percentile(lat, 0.50);
+  res.lat_p99  = percentile(lat, 0.99);
+  res.lat_p999 = percentile(lat, 0.999);
+}
+
+void bench_ops()
+{
+  // keeps "window" small reads submitted, so the pipelining handlers can overlap them
+  TUdoTransaction  tra[UDOBENCH_MAX_WINDOW];
+  uint32_t         data[UDOBENCH_MAX_WINDOW];
+  unsigned         wcnt = (cfg.window < 1 ? 1 : cfg.window);
+  unsigned         done = 0;
+  unsigned         n;
+
+  for (n = 0; n < wcnt; ++n)
+  {
+    udocomm.SubmitRead(&tra[n], 0x0000, 0, &data[n], 4);
+  }
+
+  nstime_t t0 = nstime();
+  bool running = true;
+  unsigned pending = wcnt;
+  while (pending)
+  {
+    udocomm.Poll(100);
+    running = running && (elapsed_s(t0) < cfg.duration);
+
+    for (n = 0; n < wcnt; ++n)
+    {
+      if (!tra[n].completed || !tra[n].dataptr)
+      {
+        continue;
+      }
+
+      if (tra[n].result)
+      {
+        ++res.errors;
+      }
+      else if (data[n] != 0x66CCAA55)
+      {
+        ++res.verify_errors;
+      }
+      else
+      {
+        ++done;
+      }
+
+      if (running)
+      {
+        udocomm.SubmitRead(&tra[n], 0x0000, 0, &data[n], 4);
+      }
+      else
+      {
+        tra[n].dataptr = nullptr;  // finished
+        --pending;
+      }
+    }
+  }
+
+  res.ops_per_s = done / elapsed_s(t0);
+}
+
+void bench_rqcheck()
+{
+  // the synchronous request path should not allocate and should not call setsockopt() on every request
+  uint32_t  d32;
+  unsigned  n;
+
+  try
+  {
+    for (n = 0; n < 16; ++n)  // warm-up: the first requests may set the receive timeout
+    {
+      udocomm.UdoRead(0x0000, 0, &d32, 4);
+    }
+  }
+  catch (EUdoAbort & e)
+  {
+    ++res.errors;
+  }
+
+  unsigned allocs0 = heap_alloc_count;
+  unsigned sockopts0 = udoip_commh.rcvtimeo_set_count;
+  nstime_t t0 = nstime();
+  for (n = 0; n < cfg.rqcheck; ++n)
+  {
+    try
+    {
+      udocomm.UdoRead(0x0000, 0, &d32, 4);
+    }
+    catch (EUdoAbort & e)
+    {
+      ++res.errors;
+    }
+  }
+  res.rq_ns = double(nstime() - t0) / cfg.rqcheck;
+  res.rq_allocs = double(heap_alloc_count - allocs0) / cfg.rqcheck;
+  res.rq_sockopts = double(udoip_commh.rcvtimeo_set_count - sockopts0) / cfg.rqcheck;
+}
+
+void bench_blob_read()
+{
+  uint64_t total = 0;
+  nstime_t t0 = nstime();
+  for (unsigned rep = 0; rep < cfg.blobrepeat; ++rep)
+  {
+    memset(blobbuf, 0, cfg.blobsize);
+    try
+    {
+      int r = udocomm.ReadBlob(0x0002, 0, blobbuf, cfg.blobsize);
+      if ((r != int(cfg.blobsize)) || (0 != memcmp(blobbuf, blobref, cfg.blobsize)))
+      {
+        ++res.verify_errors;
+      }
+      total += r;
+    }
+    catch (EUdoAbort & e)
+    {
+      ++res.errors;
+    }
+  }
+  res.read_mbps = total / elapsed_s(t0) / 1000000.0;
+}
+
+void bench_blob_write()
+{
+  // the blob test object checks the written values
+  uint64_t total = 0;
+  nstime_t t0 = nstime();
+  for (unsigned rep = 0; rep < cfg.blobrepeat; ++rep)
+  {
+    try
+    {
+      udocomm.WriteBlob(0x0002, 0, blobref, cfg.blobsize);
+      total += cfg.blobsize;
+    }
+    catch (EUdoAbort & e)
+    {
+      if (UDOERR_WRITE_VALUE == e.ecode)
+      {
+        ++res.verify_errors;
+      }
+      else
+      {
+        ++res.errors;
+      }
+    }
+  }
+  res.write_mbps = total / elapsed_s(t0) / 1000000.0;
+
+  // end-to-end check with the blob checksum object, when the device has it
+  try
+  {
+    uint32_t crc = udocomm.BlobCrc32(0x0002, 0, cfg.blobsize);
+    if (crc == udo_calc_crc32(0, blobref, cfg.blobsize))
+    {
+      res.crc_check = "ok";
+    }
+    else
+    {
+      res.crc_check = "failed";
+      ++res.verify_errors;
+    }
+  }
+  catch (EUdoAbort & e)
+  {
+    // not supported: n/a
+  }
+}
+
+void print_text()
+{
+  printf("latency (obj 0000, %u samples): min %.1f, avg %.1f, p50 %.1f, p99 %.1f, p999 %.1f, max %.1f us\n",
+         res.lat_samples, res.lat_min, res.lat_avg, res.lat_p50, res.lat_p99, res.lat_p999, res.lat_max);
+  printf("small objects:  %.0f ops/s\n", res.ops_per_s);
+  printf("blob read:      %.3f MB/s\n", res.read_mbps);
+  printf("blob write:     %.3f MB/s, CRC32 check: %s\n", res.write_mbps, res.crc_check);
+  if (cfg.rqcheck)
+  {
+    printf("request path:   %.3f heap allocations/read, %.3f setsockopt/read, %.0f ns/read\n",
+           res.rq_allocs, res.rq_sockopts, res.rq_ns);
+  }
+  printf("errors: %u, verify errors: %u\n", res.errors, res.verify_errors);
+}
+
+void print_json()
+{
+  printf("{\"connection\": \"%s\", \"max_payload\": %u, \"window\": %u, \"blob_size\": %u, \"blob_repeat\": %u,\n",
+         udocomm.commh->ConnString().c_str(), udocomm.max_payload_size, cfg.window, cfg.blobsize, cfg.blobrepeat);
+  printf(" \"latency_us\": {\"samples\": %u, \"min\": %.2f, \"avg\": %.2f, \"p50\": %.2f, \"p99\": %.2f, \"p999\": %.2f, \"max\": %.2f},\n",
+         res.lat_samples, res.lat_min, res.lat_avg, res.lat_p50, res.lat_p99, res.lat_p999, res.lat_max);
+  printf(" \"ops_per_s\": %.1f, \"blob_read_mbps\": %.4f, \"blob_write_mbps\": %.4f, \"crc_check\": \"%s\",\n",
+         res.ops_per_s, res.read_mbps, res.write_mbps, res.crc_check);
+  if (cfg.rqcheck)
+  {
+    printf(" \"rq_allocs_per_read\": %.4f, \"rq_setsockopt_per_read\": %.4f, \"rq_ns_per_read\": %.1f,\n",
+           res.rq_allocs, res.rq_sockopts, res.rq_ns);
+  }
+  printf(" \"errors\": %u, \"verify_errors\": %u}\n", res.errors, res.verify_errors);
+}
+
+void print_usage()
+{
+  printf("usage: udobench [options] <device>\n");
+  printf("  <device>      IP address[:port] for UDO-IP, serial device (/dev/ttyACM0, COM3) for UDO-SL\n");
+  printf("  -n <count>    latency samples (default 1000)\n");
+  printf("  -t <sec>      duration of the small object ops/s measurement (default 2)\n");
+  printf("  -s <bytes>    blob transfer size, max 262144 (default 262144)\n");
+  printf("  -r <count>    blob transfer repetitions (default 4)\n");
+  printf("  -w <count>    pipelining window, max. requests in flight (default 1)\n");
+  printf("  -b <baud>     UDO-SL baud rate (default 1000000)\n");
+  printf("  -m <count>    request path overhead check: heap allocations and setsockopt calls\n");
+  printf("                per synchronous read, measured over <count> reads (default off)\n");
+  printf("  -j            JSON output\n");
+}
+
+bool parse_args(int argc, char * const * argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const char * arg = argv[i];
+    if (('-' == arg[0]) && arg[1] && !arg[2])
+    {
+      if ('j' == arg[1])
+      {
+        cfg.json = true;
+        continue;
+      }
+
+      if (i + 1 >= argc)
+      {
+        return false;
+      }
+      const char * val = argv[++i];
+
+      switch (arg[1])
+      {
+        case 'n':  cfg.samples = strtoul(val, nullptr, 0);  break;
+        case 't':  cfg.duration = atof(val);  break;
+        case 's':  cfg.blobsize = strtoul(val, nullptr, 0);  break;
+        case 'r':  cfg.blobrepeat = strtoul(val, nullptr, 0);  break;
+        case 'w':  cfg.window = strtoul(val, nullptr, 0);  break;
+        case 'b':  cfg.baudrate = strtoul(val, nullptr, 0);  break;
+        case 'm':  cfg.rqcheck = strtoul(val, nullptr, 0);  break;
+        default:   return false;
+      }
+    }
+    else
+    {
+      cfg.devstr = arg;
+    }
+  }
+
+  if (cfg.blobsize > UDOBENCH_BLOB_SIZE)  cfg.blobsize = UDOBENCH_BLOB_SIZE;
+  cfg.blobsize &= ~3;  // the blob test object works with 32-bit words
+  if (cfg.window < 1)  cfg.window = 1;
+  if (cfg.window > UDOBENCH_MAX_WINDOW)  cfg.window = UDOBENCH_MAX_WINDOW;
+
+  return !cfg.devstr.empty();
+}
+
+int main(int argc, char * const * argv)
+{
+  if (!parse_args(argc, argv))
+  {
+    print_usage();
+    return 1;
+  }
+
+  if (('/' == cfg.devstr[0]) || (0 == cfg.devstr.compare(0, 3, "COM")))
+  {
+    udosl_commh.devstr = cfg.devstr;
+    udosl_commh.comm.baudrate = cfg.baudrate;
+    udosl_commh.max_inflight = cfg.window;
+    udocomm.SetHandler(&udosl_commh);
+  }
+  else
+  {
+    udoip_commh.ipaddrstr = cfg.devstr;
+    udoip_commh.max_inflight = cfg.window;
+    udocomm.SetHandler(&udoip_commh);
+  }
+
+  try
+  {
+    udocomm.Open();
+  }
+  catch (EUdoAbort & e)
+  {
+    printf("%s\n", e.what());
+    return 1;
+  }
+
+  if (!cfg.json)
+  {
+    printf("UDOBENCH - %s, max. payload: %u, window: %u\n",
+           udocomm.commh->ConnString().c_str(), udocomm.max_payload_size, cfg.window);
+  }
+
+  for (unsigned n = 0; n < UDOBENCH_BLOB_SIZE / 4; ++n)
+  {
+    blobref[n] = n;
+  }
+
+  if (cfg.rqcheck)
+  {
+    bench_rqcheck();
+  }
+  bench_latency();
+  bench_ops();
+  if (cfg.blobsize && cfg.blobrepeat)
+  {
+    bench_blob_read();
+    bench_blob_write();
+  }
+
+  if (cfg.json)
+  {
+    print_json();
+  }
+  else
+  {
+    print_text();
+  }
+
+  udocomm.Close();
+
+  return ((res.errors || res.verify_errors) ? 2 : 0);
+}
@@ -7,6 +7,7 @@
 
 #include "string.h"
 #include "stdlib.h"
+#include "stdio.h"
 #include "udo.h"
 #include "udo_comm.h"
 #include "commh_udoip.h"
@@ -14,6 +15,10 @@
 #include <unistd.h>
 #include "general.h"
 
+#ifndef WINDOWS
+  #include <poll.h>
+#endif
+
 TCommHandlerUdoIp  udoip_commh;
 
 #ifdef WINDOWS
@@ -40,11 +45,14 @@ TCommHandlerUdoIp::TCommHandlerUdoIp()
 
 	default_timeout = 0.5;  // lower the default timeout
 	timeout = default_timeout;
+
+	max_payload_ext = UDOIP_MAX_PAYLOAD_EXT;
 }
 
 TCommHandlerUdoIp::~TCommHandlerUdoIp()
 {
-	// TODO Auto-generated destructor stub
+	delete[] rqbuf;
+	delete[] ansbuf;
 }
 
 void TCommHandlerUdoIp::Open()
@@ -89,10 +97,38 @@ void TCommHandlerUdoIp::Open()
 #endif
 
   cursqnum = 0;  // always start at zero, and increment, the port number will be at every connection different
+  max_payload = UDOIP_MAX_DATALEN;  // until the negotiation
+
+  uint32_t needed = sizeof(TUdoIpRqHeader) + 4 + (max_payload_ext > UDOIP_MAX_DATALEN ? max_payload_ext : UDOIP_MAX_DATALEN);
+  if (bufsize < needed)
+  {
+    delete[] rqbuf;
+    delete[] ansbuf;
+    bufsize = needed;
+    rqbuf  = new uint8_t[bufsize];
+    ansbuf = new uint8_t[bufsize];
+  }
+
+  srtt = 0;
+  rttvar = 0;
+  rto = 0;
+  rcvtimeo_applied = 0;  // new socket
 }
 
 void TCommHandlerUdoIp::Close()
 {
+  // abort the pending transactions
+  while (inflight_first)
+  {
+    TUdoTransaction * tra = inflight_first;
+    UnlinkInflight(nullptr, tra);
+    CompleteTransaction(tra, UDOERR_CONNECTION);
+  }
+  while (queue_first)
+  {
+    CompleteTransaction(DequeueTransaction(), UDOERR_CONNECTION);
+  }
+
 	if (fdsocket >= 0)
 	{
 		close(fdsocket);
@@ -115,102 +151,179 @@ int TCommHandlerUdoIp::UdoRead(uint16_t index, uint32_t offset, void * dataptr,
   iswrite = false;
 	mindex  = index;
   moffset = offset;
+  mmetadata = exec_metadata;
   mdataptr = (uint8_t *)dataptr;
   mrqlen = maxdatalen;
-
-  opstring = StringFormat("UdoRead(%.4X, %d)", mindex, moffset);
+  mrqextlen = 0;
 
   DoUdoReadWrite();
 
 	return ans_datalen;
 }
 
+int TCommHandlerUdoIp::UdoMultiRead(TUdoMultiReadItem * items, unsigned count, void * dataptr, uint32_t maxdatalen)
+{
+  if (Busy())
+  {
+    // the list can not be attached to a queued transaction
+    return super::UdoMultiRead(items, count, dataptr, maxdatalen);
+  }
+
+  // the list is sent together with the read request, the offset holds the item count
+  iswrite = false;
+  mindex  = 0x0003;
+  moffset = count;
+  mmetadata = 0;
+  mdataptr = (uint8_t *)dataptr;
+  mrqlen = maxdatalen;
+  mrqext = (uint8_t *)items;
+  mrqextlen = count * sizeof(TUdoMultiReadItem);
+
+  DoUdoReadWrite();
+
+  return ans_datalen;
+}
+
 void TCommHandlerUdoIp::UdoWrite(uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen)
 {
   iswrite = true;
   mindex = index;
   moffset  = offset;
+  mmetadata = exec_metadata;
   mdataptr = (uint8_t *)dataptr;
   mrqlen = datalen;
 
-  if (mrqlen > UDOIP_MAX_DATALEN)
+  if (mrqlen > max_payload)
   {
-  	throw EUdoAbort(UDOERR_DATA_TOO_BIG, "%s write data is too big: %d", opstring, mrqlen);
+  	throw EUdoAbort(UDOERR_DATA_TOO_BIG, "%s write data is too big: %d", OpString(), mrqlen);
   }
 
-  opstring = StringFormat("UdoWrite(%.4X, %d)[%d]", mindex, moffset, mrqlen);
-
   DoUdoReadWrite();
 }
 
+int TCommHandlerUdoIp::PrepareRqHeader(uint32_t arqid, bool awrite, uint16_t aindex, uint32_t aoffset,
+                                       uint32_t ametadata, uint32_t alen)
+{
+  TUdoIpRqHeader * rqhead = (TUdoIpRqHeader *)&rqbuf[0];
+  int headsize = sizeof(TUdoIpRqHeader);
+
+  rqhead->rqid     = arqid;
+  rqhead->index    = aindex;
+  rqhead->offset   = aoffset;
+  rqhead->metadata = ametadata;
+
+  uint16_t lenfield = alen;
+  if (alen >= UDOIP_LEN_EXT)  // large payload: the length follows the header
+  {
+    lenfield = UDOIP_LEN_EXT;
+    memcpy(&rqbuf[headsize], &alen, 4);
+    headsize += 4;
+  }
+
+  rqhead->len_cmd = (awrite ? (lenfield | (1 << 15)) : lenfield);  // bit15 = 0: read
+  return headsize;
+}
+
+const char * TCommHandlerUdoIp::OpString()
+{
+  if (iswrite)
+  {
+    snprintf(opstrbuf, sizeof(opstrbuf), "UdoWrite(%.4X, %u)[%u]", mindex, moffset, mrqlen);
+  }
+  else if (mrqextlen)
+  {
+    snprintf(opstrbuf, sizeof(opstrbuf), "UdoMultiRead(%u)", moffset);
+  }
+  else
+  {
+    snprintf(opstrbuf, sizeof(opstrbuf), "UdoRead(%.4X, %u)", mindex, moffset);
+  }
+  return opstrbuf;
+}
+
 void TCommHandlerUdoIp::DoUdoReadWrite()
 {
-  socklen_t rsp_addr_len;
   int r;
   int trynum;
   uint16_t ecode;
-  struct timeval tv;
+  nstime_t sendtime;
+
+  if (Busy())
+  {
+    // asynchronous transactions are in progress, the answers must be matched by the pipeline
+    TUdoTransaction tra;
+    tra.iswrite  = iswrite;
+    tra.index    = mindex;
+    tra.offset   = moffset;
+    tra.metadata = mmetadata;
+    tra.rqlen    = mrqlen;
+    tra.dataptr  = mdataptr;
+    ExecQueued(&tra);
+    if (tra.result)
+    {
+      throw EUdoAbort(tra.result, "%s result: %.4X", OpString(), tra.result);
+    }
+    ans_datalen = tra.anslen;
+    return;
+  }
 
   ++cursqnum; // increment the sequence number at every new request
 
-  TUdoIpRqHeader * rqhead = (TUdoIpRqHeader *)&rqbuf[0];
   TUdoIpRqHeader * anshead = (TUdoIpRqHeader *)&ansbuf[0];
   int headsize = sizeof(TUdoIpRqHeader);
 
-  rqhead->rqid     = cursqnum;
-  rqhead->index    = mindex;
-  rqhead->offset   = moffset;
-  rqhead->metadata = mmetadata;
+  if (!iswrite && (mrqlen > max_payload))
+  {
+    mrqlen = max_payload;  // the device can not answer more
+  }
 
+  int sendlen = PrepareRqHeader(cursqnum, iswrite, mindex, moffset, mmetadata, mrqlen);
   if (iswrite)
   {
-    rqhead->len_cmd = (mrqlen | (1 << 15));
-    memcpy(&rqbuf[headsize], mdataptr, mrqlen);
+    memcpy(&rqbuf[sendlen], mdataptr, mrqlen);
+    sendlen += mrqlen;
   }
-  else  // read
+  else if (mrqextlen)  // read with request data
   {
-    rqhead->len_cmd = mrqlen;  // bit15 = 0: read
-  };
-
+    memcpy(&rqbuf[sendlen], mrqext, mrqextlen);
+    sendlen += mrqextlen;
+  }
 
-#ifdef WINDOWS
-  int timeout_ms = timeout * 1000;
-  setsockopt(fdsocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout_ms, sizeof(timeout_ms));
-#else
-  tv.tv_sec = timeout;
-  tv.tv_usec = int(timeout * 1000000) % 1000000;
-  setsockopt(fdsocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(struct timeval));
-#endif
 
   trynum = 0;
   while (true)
   {
   	++trynum;
 
-		r = sendto(fdsocket, (char *)&rqbuf[0], headsize + mrqlen, 0, (sockaddr *)&server_addr, sizeof(server_addr));
+		SetRecvTimeout(TryTimeout(trynum));
+
+		sendtime = nstime();
+		r = sendto(fdsocket, (char *)&rqbuf[0], sendlen, 0, (sockaddr *)&server_addr, sizeof(server_addr));
 		//printf("sendto result: %i, errno=%i\n", r, errno);
     if (r < 0)
     {
-    	throw EUdoAbort(UDOERR_CONNECTION, "%s: send error: %d", opstring.c_str(), errno);
+    	throw EUdoAbort(UDOERR_CONNECTION, "%s: send error: %d", OpString(), errno);
     }
 
-    rsp_addr_len = sizeof(response_addr);
-		r = recvfrom(fdsocket, (char *)&ansbuf[0], sizeof(ansbuf), 0, (sockaddr *)&response_addr, &rsp_addr_len);
-		//printf("recvfrom result: %i, errno = %i\n", r, errno);
+		// the read data goes directly to the caller's buffer,
+		// late answers of the previous requests (repeated by the short retransmission timeout) are dropped
+		r = RecvCurrentAnswer((iswrite ? nullptr : mdataptr), (iswrite ? 0 : mrqlen), sendtime + TryTimeout(trynum));
+
 		if (r <= 0)
 		{
 			if (errno == EAGAIN)
 			{
 				if (trynum < max_tries)
 				{
+					RtoBackoff();
 					continue;  // re-send on timeout
 				}
 
-				throw EUdoAbort(UDOERR_TIMEOUT, "%s: timeout", opstring.c_str());
+				throw EUdoAbort(UDOERR_TIMEOUT, "%s: timeout", OpString());
 			}
 			else
 			{
-				throw EUdoAbort(UDOERR_CONNECTION, "%s: receive error: %i", opstring.c_str(), errno);
+				throw EUdoAbort(UDOERR_CONNECTION, "%s: receive error: %i", OpString(), errno);
 			}
 		}
 
@@ -223,7 +336,7 @@ void TCommHandlerUdoIp::DoUdoReadWrite()
 				continue;
 			}
 
-			throw EUdoAbort(UDOERR_CONNECTION, "%s invalid response length: %d", opstring.c_str(), ans_datalen);
+			throw EUdoAbort(UDOERR_CONNECTION, "%s invalid response length: %d", OpString(), ans_datalen);
 		}
 
 		if ((anshead->rqid != cursqnum) || (anshead->index != mindex) || (anshead->offset != moffset))
@@ -233,18 +346,18 @@ void TCommHandlerUdoIp::DoUdoReadWrite()
 				continue;
 			}
 
-			throw EUdoAbort(UDOERR_CONNECTION, "%s unexpected response", opstring.c_str());
+			throw EUdoAbort(UDOERR_CONNECTION, "%s unexpected response", OpString());
 		}
 
 		if ((anshead->len_cmd & 0x7FF) == 0x7FF) // error response ?
 		{
 			if (r < int(sizeof(TUdoIpRqHeader) + 2))
 			{
-				throw EUdoAbort(UDOERR_CONNECTION, "%s error response length: %d", opstring.c_str(), r);
+				throw EUdoAbort(UDOERR_CONNECTION, "%s error response length: %d", OpString(), r);
 			}
 
-			ecode = *(uint16_t *)&ansbuf[headsize];
-			throw EUdoAbort(ecode, "%s result: %.4X", opstring.c_str(), ecode);
+			CopyAnswerData(&ecode, 2, (iswrite ? nullptr : mdataptr), (iswrite ? 0 : mrqlen));
+			throw EUdoAbort(ecode, "%s result: %.4X", OpString(), ecode);
 		}
 
 		if (!iswrite)
@@ -253,14 +366,530 @@ void TCommHandlerUdoIp::DoUdoReadWrite()
 			{
 				if (ans_datalen > int(mrqlen))
 				{
-					throw EUdoAbort(UDOERR_DATA_TOO_BIG, "%s result data is too big: %d", opstring.c_str(), ans_datalen);
+					throw EUdoAbort(UDOERR_DATA_TOO_BIG, "%s result data is too big: %d", OpString(), ans_datalen);
 				}
-
-				memcpy(mdataptr, &ansbuf[headsize], ans_datalen);
+				// the data is already in the mdataptr
 			}
 		}
 
+		if (1 == trynum)
+		{
+			RttSample(nstime() - sendtime);
+		}
+
 		break; // everything was ok.
 
 	} // while
 }
+
+void TCommHandlerUdoIp::UdoTransactions(TUdoTransaction * atra, unsigned acount, bool astop_on_short)
+{
+  if ((max_inflight <= 1) && !Busy())
+  {
+    super::UdoTransactions(atra, acount, astop_on_short);  // one by one
+    return;
+  }
+
+  // windowed mode: keep max_inflight requests (with different rqid-s) outstanding,
+  // match the answers as they arrive and resend only the missing ones
+
+  unsigned   n;
+  unsigned   nextsend = 0;   // the next transaction to send
+  unsigned   firstopen = 0;  // all transactions before this are completed
+  bool       stopsend = false;
+  unsigned   window = (max_inflight > 1 ? max_inflight : 1);
+
+  for (n = 0; n < acount; ++n)
+  {
+    atra[n].completed = false;
+    atra[n].oncomplete = nullptr;
+  }
+
+  while (true)
+  {
+    // the queued asynchronous transactions were submitted earlier, they go first
+    FillWindow();
+    while (!stopsend && !queue_first && (nextsend < acount) && (inflight_count < window))
+    {
+      StartTransaction(&atra[nextsend]);
+      ++nextsend;
+    }
+
+    while ((firstopen < nextsend) && atra[firstopen].completed)
+    {
+      TUdoTransaction * tra = &atra[firstopen];
+      if (astop_on_short && (tra->result || (!tra->iswrite && (tra->anslen < int(tra->rqlen)))))
+      {
+        stopsend = true;
+      }
+      ++firstopen;
+    }
+
+    if ((firstopen >= nextsend) && (stopsend || (nextsend >= acount)))
+    {
+      completion_count -= nextsend;  // these were not submitted, the Poll() does not report them
+      return;  // everything was processed
+    }
+
+    if (WaitForAnswer(CheckTimeouts()))
+    {
+      ReceiveAnswer();
+    }
+  }
+}
+
+void TCommHandlerUdoIp::SubmitTransaction(TUdoTransaction * atra)
+{
+  atra->completed = false;
+  QueueTransaction(atra);
+  FillWindow();
+}
+
+void TCommHandlerUdoIp::Progress(int atimeout_ms)
+{
+  nstime_t deadline = nstime() + nstime_t(atimeout_ms) * 1000000;
+  int      startcount = completion_count;
+
+  while (true)
+  {
+    FillWindow();
+    nstime_t waittime = CheckTimeouts();
+    if (0 == inflight_count)
+    {
+      break;
+    }
+
+    // wait until the first completion, then only process what is already received
+    nstime_t remaining = deadline - nstime();
+    if ((completion_count > startcount) || (remaining < 0))  remaining = 0;
+    if (waittime > remaining)  waittime = remaining;
+
+    if (WaitForAnswer(waittime))
+    {
+      ReceiveAnswer();
+    }
+    else if (waittime >= remaining)
+    {
+      break;
+    }
+  }
+}
+
+int TCommHandlerUdoIp::PollFd()
+{
+  return fdsocket;
+}
+
+bool TCommHandlerUdoIp::Busy()
+{
+  return (queue_first || inflight_count);
+}
+
+void TCommHandlerUdoIp::FillWindow()
+{
+  unsigned window = (max_inflight > 1 ? max_inflight : 1);
+  while (queue_first && (inflight_count < window))
+  {
+    StartTransaction(DequeueTransaction());
+  }
+}
+
+void TCommHandlerUdoIp::StartTransaction(TUdoTransaction * tra)
+{
+  tra->result = 0;
+  tra->anslen = 0;
+  tra->trynum = 0;
+
+  ++cursqnum;
+  tra->rqid = cursqnum;
+
+  if (tra->iswrite && (tra->rqlen > max_payload))
+  {
+    CompleteTransaction(tra, UDOERR_DATA_TOO_BIG);
+    return;
+  }
+
+  if (!SendTransaction(tra))
+  {
+    CompleteTransaction(tra, UDOERR_CONNECTION);
+    return;
+  }
+
+  // append to the in-flight list
+  tra->next = nullptr;
+  if (inflight_last)
+  {
+    inflight_last->next = tra;
+  }
+  else
+  {
+    inflight_first = tra;
+  }
+  inflight_last = tra;
+  ++inflight_count;
+}
+
+bool TCommHandlerUdoIp::SendTransaction(TUdoTransaction * tra)
+{
+  uint32_t rqlen = tra->rqlen;
+  if (!tra->iswrite && (rqlen > max_payload))
+  {
+    rqlen = max_payload;  // the device can not answer more
+  }
+
+  int sendlen = PrepareRqHeader(tra->rqid, tra->iswrite, tra->index, tra->offset, tra->metadata, rqlen);
+  if (tra->iswrite)
+  {
+    memcpy(&rqbuf[sendlen], tra->dataptr, tra->rqlen);
+    sendlen += tra->rqlen;
+  }
+
+  ++tra->trynum;
+  tra->sendtime = nstime();
+
+  int r = sendto(fdsocket, (char *)&rqbuf[0], sendlen, 0, (sockaddr *)&server_addr, sizeof(server_addr));
+  return (r == sendlen);
+}
+
+void TCommHandlerUdoIp::UnlinkInflight(TUdoTransaction * prev, TUdoTransaction * tra)
+{
+  if (prev)
+  {
+    prev->next = tra->next;
+  }
+  else
+  {
+    inflight_first = tra->next;
+  }
+
+  if (inflight_last == tra)
+  {
+    inflight_last = prev;
+  }
+
+  tra->next = nullptr;
+  --inflight_count;
+}
+
+nstime_t TCommHandlerUdoIp::CheckTimeouts()
+{
+  nstime_t result = TryTimeout(max_tries);
+  nstime_t t = nstime();
+  bool     backoff = false;
+
+  TUdoTransaction * prev = nullptr;
+  TUdoTransaction * tra = inflight_first;
+  while (tra)
+  {
+    TUdoTransaction * next = tra->next;
+
+    nstime_t timeout_ns = TryTimeout(tra->trynum);
+    nstime_t elapsed = t - tra->sendtime;
+    if (elapsed >= timeout_ns)
+    {
+      if (!backoff && (tra->trynum < max_tries))
+      {
+        RtoBackoff();  // only once for a burst of losses
+        backoff = true;
+      }
+
+      if ((tra->trynum < max_tries) && SendTransaction(tra)) // re-send with the same rqid
+      {
+        timeout_ns = TryTimeout(tra->trynum);
+        elapsed = 0;
+      }
+      else
+      {
+        UnlinkInflight(prev, tra);
+        CompleteTransaction(tra, UDOERR_TIMEOUT);
+        tra = next;
+        continue;
+      }
+    }
+
+    if (timeout_ns - elapsed < result)  result = timeout_ns - elapsed;
+
+    prev = tra;
+    tra = next;
+  }
+
+  return result;
+}
+
+bool TCommHandlerUdoIp::WaitForAnswer(nstime_t awaittime)
+{
+  if (awaittime < 0)  awaittime = 0;
+
+#ifdef WINDOWS
+  // the winsock fd_set is a socket list, it has no descriptor number limit
+  fd_set          rfds;
+  struct timeval  tv;
+
+  FD_ZERO(&rfds);
+  FD_SET(fdsocket, &rfds);
+  tv.tv_sec = awaittime / 1000000000;
+  tv.tv_usec = (awaittime % 1000000000) / 1000;
+  int r = select(fdsocket + 1, &rfds, nullptr, nullptr, &tv);
+#else
+  // poll() works with any descriptor number (select() is limited to FD_SETSIZE)
+  struct pollfd pfd;
+  pfd.fd = fdsocket;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  int r = poll(&pfd, 1, int((awaittime + 999999) / 1000000));  // rounded up to not spin
+#endif
+  return (r > 0);
+}
+
+bool TCommHandlerUdoIp::ReceiveAnswer()
+{
+  int headsize = sizeof(TUdoIpRqHeader);
+  TUdoIpRqHeader * anshead = (TUdoIpRqHeader *)&ansbuf[0];
+
+  // the answers arrive mostly in order: receive the data directly into the oldest read transaction,
+  // when the header shows that it is its answer
+  TUdoTransaction * ptra = inflight_first;
+  uint8_t *  pdata    = nullptr;
+  uint32_t   pdatalen = 0;
+  if (ptra && !ptra->iswrite && (PeekAnswerHead() >= headsize) && (anshead->rqid == ptra->rqid))
+  {
+    pdata    = ptra->dataptr;
+    pdatalen = ptra->rqlen;
+  }
+
+  int r = RecvAnswer(pdata, pdatalen);
+  if (r < headsize)
+  {
+    return false;  // something invalid received, the timeout handling will resend
+  }
+
+  // find the matching transaction
+  TUdoTransaction * prev = nullptr;
+  TUdoTransaction * tra = inflight_first;
+  while (tra)
+  {
+    if (tra->rqid == anshead->rqid)
+    {
+      break;
+    }
+    prev = tra;
+    tra = tra->next;
+  }
+
+  if (!tra || (anshead->index != tra->index) || (anshead->offset != tra->offset))
+  {
+    return false;  // late answer of an already completed transaction or unexpected response
+  }
+
+  if (1 == tra->trynum)
+  {
+    RttSample(nstime() - tra->sendtime);
+  }
+
+  uint16_t result = 0;
+  int ansdatalen = r - headsize;
+  if ((anshead->len_cmd & 0x7FF) == 0x7FF) // error response ?
+  {
+    if (ansdatalen < 2)
+    {
+      result = UDOERR_CONNECTION;
+    }
+    else
+    {
+      CopyAnswerData(&result, 2, pdata, pdatalen);
+    }
+  }
+  else if (!tra->iswrite && (ansdatalen > 0))
+  {
+    if (ansdatalen > int(tra->rqlen))
+    {
+      result = UDOERR_DATA_TOO_BIG;
+    }
+    else
+    {
+      if (tra != ptra)  // received into an other buffer
+      {
+        CopyAnswerData(tra->dataptr, ansdatalen, pdata, pdatalen);
+      }
+      tra->anslen = ansdatalen;
+    }
+  }
+
+  UnlinkInflight(prev, tra);
+  CompleteTransaction(tra, result);
+  return true;
+}
+
+void TCommHandlerUdoIp::RttSample(nstime_t artt)
+{
+  if (0 == srtt)  // first measurement
+  {
+    srtt = artt;
+    rttvar = artt / 2;
+  }
+  else
+  {
+    nstime_t delta = srtt - artt;
+    if (delta < 0)  delta = -delta;
+    rttvar += (delta - rttvar) / 4;
+    srtt   += (artt - srtt) / 8;
+  }
+
+  rto = srtt + 4 * rttvar;
+}
+
+void TCommHandlerUdoIp::RtoBackoff()
+{
+  if (rto)
+  {
+    rto *= 2;  // stays until the next valid measurement
+    if (rto > nstime_t(timeout * 1000000000))  rto = nstime_t(timeout * 1000000000);
+  }
+}
+
+nstime_t TCommHandlerUdoIp::TryTimeout(int atrynum)
+{
+  nstime_t tmax = nstime_t(timeout * 1000000000);
+  if (!adaptive_rto || !rto || (atrynum >= max_tries))
+  {
+    return tmax;
+  }
+
+  nstime_t tmin = nstime_t(min_rto * 1000000000);
+  if (rto < tmin)  return (tmin < tmax ? tmin : tmax);
+  if (rto > tmax)  return tmax;
+  return rto;
+}
+
+void TCommHandlerUdoIp::SetRecvTimeout(nstime_t atimeout)
+{
+  // rounded up to ms, so that the small rto changes do not require a new setsockopt() every time
+  atimeout = ((atimeout + 999999) / 1000000) * 1000000;
+  if (atimeout < 1000000)  atimeout = 1000000;  // zero would mean no timeout
+
+  if (atimeout == rcvtimeo_applied)
+  {
+    return;
+  }
+  rcvtimeo_applied = atimeout;
+  ++rcvtimeo_set_count;
+
+#ifdef WINDOWS
+  DWORD timeout_ms = atimeout / 1000000;
+  setsockopt(fdsocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout_ms, sizeof(timeout_ms));
+#else
+  struct timeval tv;
+  tv.tv_sec = atimeout / 1000000000;
+  tv.tv_usec = (atimeout % 1000000000) / 1000;
+  setsockopt(fdsocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(struct timeval));
+#endif
+}
+
+int TCommHandlerUdoIp::RecvAnswer(uint8_t * adataptr, uint32_t adatalen)
+{
+  int headsize = sizeof(TUdoIpRqHeader);
+  rsp_addr_len = sizeof(response_addr);
+
+#ifdef WINDOWS
+  int r = recvfrom(fdsocket, (char *)&ansbuf[0], bufsize, 0, (sockaddr *)&response_addr, &rsp_addr_len);
+  if (adataptr && (r > headsize))
+  {
+    // no scatter receive here: copy the first part, the rest goes to the start of the data area
+    uint32_t len = r - headsize;
+    if (len > adatalen)  len = adatalen;
+    memcpy(adataptr, &ansbuf[headsize], len);
+    memmove(&ansbuf[headsize], &ansbuf[headsize + len], r - headsize - len);
+  }
+  return r;
+#else
+  struct iovec  iov[3];
+  struct msghdr msg;
+  unsigned      iovcnt = 0;
+
+  iov[iovcnt].iov_base = &ansbuf[0];
+  iov[iovcnt].iov_len  = headsize;
+  ++iovcnt;
+  if (adataptr && adatalen)
+  {
+    iov[iovcnt].iov_base = adataptr;
+    iov[iovcnt].iov_len  = adatalen;
+    ++iovcnt;
+  }
+  iov[iovcnt].iov_base = &ansbuf[headsize];  // error code, too long answers
+  iov[iovcnt].iov_len  = bufsize - headsize;
+  ++iovcnt;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name    = &response_addr;
+  msg.msg_namelen = rsp_addr_len;
+  msg.msg_iov     = &iov[0];
+  msg.msg_iovlen  = iovcnt;
+
+  int r = recvmsg(fdsocket, &msg, 0);
+  rsp_addr_len = msg.msg_namelen;
+  return r;
+#endif
+}
+
+int TCommHandlerUdoIp::PeekAnswerHead()
+{
+  int headsize = sizeof(TUdoIpRqHeader);
+  int r = recv(fdsocket, (char *)&ansbuf[0], headsize, MSG_PEEK);
+#ifdef WINDOWS
+  if ((r < 0) && (WSAGetLastError() == WSAEMSGSIZE))
+  {
+    r = headsize;  // the datagram is longer than the header, the header was copied
+  }
+#endif
+  return r;
+}
+
+int TCommHandlerUdoIp::RecvCurrentAnswer(uint8_t * adataptr, uint32_t adatalen, nstime_t adeadline)
+{
+  int headsize = sizeof(TUdoIpRqHeader);
+  TUdoIpRqHeader * anshead = (TUdoIpRqHeader *)&ansbuf[0];
+
+  // the first wait is done by the receive timeout of the socket
+  int r = PeekAnswerHead();
+  while (true)
+  {
+    if (r < headsize)
+    {
+      return (r < 0 ? r : RecvAnswer(nullptr, 0));  // error, timeout or something invalid
+    }
+
+    if (anshead->rqid == cursqnum)
+    {
+      return RecvAnswer(adataptr, adatalen);
+    }
+
+    RecvAnswer(nullptr, 0);  // drop the late answer
+
+    // wait only for the rest of the time
+    nstime_t t = nstime();
+    if ((t >= adeadline) || !WaitForAnswer(adeadline - t))
+    {
+      errno = EAGAIN;
+      return -1;
+    }
+    r = PeekAnswerHead();
+  }
+}
+
+void TCommHandlerUdoIp::CopyAnswerData(void * adst, uint32_t alen, uint8_t * adataptr, uint32_t adatalen)
+{
+  int headsize = sizeof(TUdoIpRqHeader);
+  uint8_t * dst = (uint8_t *)adst;
+
+  uint32_t len = (adataptr ? adatalen : 0);
+  if (len > alen)  len = alen;
+  if (len)
+  {
+    memcpy(dst, adataptr, len);
+  }
+  if (alen > len)
+  {
+    memcpy(dst + len, &ansbuf[headsize], alen - len);
+  }
+}
@@ -30,6 +30,10 @@ using namespace std;
 
 #define UDOIP_DEFAULT_PORT  1221
 
+#ifndef UDOIP_MAX_PAYLOAD_EXT
+  #define UDOIP_MAX_PAYLOAD_EXT  61440  // large payload (object 0x0005) limit, the buffers are allocated at Open()
+#endif
+
 typedef struct
 {
 	uint32_t    rqid;       // request id to detect repeated requests
@@ -48,6 +52,13 @@ private:
 public:
 	string               ipaddrstr;
 
+	// retransmission timeout from the measured round trip times (Jacobson/Karels), the timeout
+	// is the upper bound and the last try always waits the full timeout
+	bool                 adaptive_rto = true;
+	float                min_rto = 0.005;  // lower bound of the adaptive retransmission timeout in s
+
+	unsigned             rcvtimeo_set_count = 0;  // statistics: setsockopt(SO_RCVTIMEO) calls
+
   int                  fdsocket = -1;
   struct sockaddr_in   server_addr;
   struct sockaddr_in   client_addr;
@@ -64,19 +75,27 @@ public:
 	virtual int        UdoRead(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen);
 	virtual void       UdoWrite(uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen);
 
+	virtual void       UdoTransactions(TUdoTransaction * atra, unsigned acount, bool astop_on_short);
+	virtual int        UdoMultiRead(TUdoMultiReadItem * items, unsigned count, void * dataptr, uint32_t maxdatalen);
+
+	virtual void       SubmitTransaction(TUdoTransaction * atra);
+	virtual int        PollFd();
+	virtual bool       Busy();
+
 protected:
 
   int        max_tries = 3;
   uint16_t   cursqnum = 0;
 
-  uint8_t    rqbuf[UDOIP_MAX_RQ_SIZE];
-  uint8_t    ansbuf[UDOIP_MAX_RQ_SIZE];
+  uint32_t   bufsize = 0;      // header + extended length + max(UDOIP_MAX_DATALEN, max_payload_ext)
+  uint8_t *  rqbuf = nullptr;
+  uint8_t *  ansbuf = nullptr;
 
   struct sockaddr_in   response_addr;
   socklen_t            rsp_addr_len = 0;
-  fd_set     rxpoll_fds;
 
-  string     opstring;
+  char       opstrbuf[64];
+  const char * OpString();  // formats the current operation for the error messages only
 
   bool       iswrite = false;
   uint16_t   mindex = 0;
@@ -84,14 +103,55 @@ protected:
   uint32_t   mmetadata = 0;
   uint32_t   mrqlen = 0;
   uint8_t *  mdataptr = nullptr;
+  uint8_t *  mrqext = nullptr;  // read request payload (multi-read list)
+  uint32_t   mrqextlen = 0;
 
   uint32_t   ans_index = 0;
   uint32_t   ans_offset = 0;
   uint32_t   ans_metadata = 0;
   int        ans_datalen = 0;
 
+  nstime_t   srtt = 0;     // smoothed round trip time, 0 = no measurement yet
+  nstime_t   rttvar = 0;   // round trip time variation
+  nstime_t   rto = 0;      // current retransmission timeout, 0 = use the timeout
+  nstime_t   rcvtimeo_applied = 0;  // the SO_RCVTIMEO set on the socket, 0 = not set yet
+
+  void       RttSample(nstime_t artt);  // only for answers of not repeated requests (Karn)
+  void       RtoBackoff();
+  nstime_t   TryTimeout(int atrynum);   // the answer wait time of the given try
+  void       SetRecvTimeout(nstime_t atimeout);
+
+  // prepares the request header into the rqbuf, returns the header length (with the extended length)
+  int        PrepareRqHeader(uint32_t arqid, bool awrite, uint16_t aindex, uint32_t aoffset, uint32_t ametadata, uint32_t alen);
+
   void       DoUdoReadWrite();
 
+  // receives an answer: the header into the ansbuf, the first adatalen bytes of the payload directly
+  // into adataptr (no copy), the rest behind the header in the ansbuf. Returns the full datagram length.
+  int        RecvAnswer(uint8_t * adataptr, uint32_t adatalen);
+  // reads the header of the next datagram into the ansbuf without removing it
+  int        PeekAnswerHead();
+  // RecvAnswer() for the current request (rqid = cursqnum): the late answers are dropped without touching
+  // the adataptr, the wait for the next datagrams ends at the adeadline
+  int        RecvCurrentAnswer(uint8_t * adataptr, uint32_t adatalen, nstime_t adeadline);
+  // collects the payload of the answer received by RecvAnswer(adataptr, adatalen)
+  void       CopyAnswerData(void * adst, uint32_t alen, uint8_t * adataptr, uint32_t adatalen);
+
+protected: // pipeline / asynchronous processing
+
+  TUdoTransaction *  inflight_first = nullptr;  // sent, waiting for the answer
+  TUdoTransaction *  inflight_last = nullptr;
+  unsigned           inflight_count = 0;
+
+  void       FillWindow();
+  void       StartTransaction(TUdoTransaction * tra);
+  bool       SendTransaction(TUdoTransaction * tra);
+  void       UnlinkInflight(TUdoTransaction * prev, TUdoTransaction * tra);
+  nstime_t   CheckTimeouts();  // resends the expired requests, returns the time to the next expiry
+  bool       WaitForAnswer(nstime_t awaittime);
+  bool       ReceiveAnswer();
+  virtual void Progress(int atimeout_ms);
+
 };
 
 extern TCommHandlerUdoIp  udoip_commh;
@@ -6,6 +6,7 @@
  */
 
 #include "string.h"
+#include "stdio.h"
 #include "commh_udosl.h"
 #include "general.h"
 
@@ -33,6 +34,13 @@ void TCommHandlerUdoSl::Open()
 
 void TCommHandlerUdoSl::Close()
 {
+  // abort the pending transactions
+  AbortInflight(UDOERR_CONNECTION);
+  while (queue_first)
+  {
+    CompleteTransaction(DequeueTransaction(), UDOERR_CONNECTION);
+  }
+
 	comm.Close();
 }
 
@@ -51,17 +59,34 @@ int TCommHandlerUdoSl::UdoRead(uint16_t index, uint32_t offset, void * dataptr,
   iswrite = false;
 	mindex  = index;
   moffset = offset;
+  mmetadata = exec_metadata;
   mdataptr = (uint8_t *)dataptr;
   mrqlen = maxdatalen;
 
-  opstring = StringFormat("UdoRead(%.4X, %d)", mindex, moffset);
+  if (Busy())
+  {
+    // asynchronous transactions are in progress, execute it behind them
+    TUdoTransaction tra;
+    tra.iswrite  = false;
+    tra.index    = index;
+    tra.offset   = offset;
+    tra.metadata = mmetadata;
+    tra.rqlen    = maxdatalen;
+    tra.dataptr  = mdataptr;
+    ExecQueued(&tra);
+    if (tra.result)
+    {
+      throw EUdoAbort(tra.result, "%s result: %.4X", OpString(), tra.result);
+    }
+    return tra.anslen;
+  }
 
 	SendRequest();
   RecvResponse();
 
 	if (ans_datalen > int(maxdatalen))
   {
-		throw EUdoAbort(UDOERR_DATA_TOO_BIG, "%s result data is too big: %d", opstring, ans_datalen);
+		throw EUdoAbort(UDOERR_DATA_TOO_BIG, "%s result data is too big: %d", OpString(), ans_datalen);
   }
 
   // copy the response to the user buffer
@@ -78,22 +103,55 @@ void TCommHandlerUdoSl::UdoWrite(uint16_t index, uint32_t offset, void * dataptr
   iswrite = true;
   mindex = index;
   moffset  = offset;
+  mmetadata = exec_metadata;
   mdataptr = (uint8_t *)dataptr;
   mrqlen = datalen;
 
-  opstring = StringFormat("UdoWrite(%.4X, %d)[%d]", mindex, moffset, mrqlen);
+  if (Busy())
+  {
+    // asynchronous transactions are in progress, execute it behind them
+    TUdoTransaction tra;
+    tra.iswrite  = true;
+    tra.index    = index;
+    tra.offset   = offset;
+    tra.metadata = mmetadata;
+    tra.rqlen    = datalen;
+    tra.dataptr  = mdataptr;
+    ExecQueued(&tra);
+    if (tra.result)
+    {
+      throw EUdoAbort(tra.result, "%s result: %.4X", OpString(), tra.result);
+    }
+    return;
+  }
 
   SendRequest();
   RecvResponse();
 }
 
+const char * TCommHandlerUdoSl::OpString()
+{
+  if (iswrite)
+  {
+    snprintf(opstrbuf, sizeof(opstrbuf), "UdoWrite(%.4X, %u)[%u]", mindex, moffset, mrqlen);
+  }
+  else
+  {
+    snprintf(opstrbuf, sizeof(opstrbuf), "UdoRead(%.4X, %u)", mindex, moffset);
+  }
+  return opstrbuf;
+}
+
 void TCommHandlerUdoSl::SendRequest()
 {
 	int r;
 	uint8_t  b;
 
-	comm.FlushInput();
-	comm.FlushOutput();
+	if (!inflight_first)  // the answers of the pipelined requests must be kept
+	{
+		comm.FlushInput();
+		comm.FlushOutput();
+	}
 
 	uint8_t offslen;
   if      (moffset ==     0)  offslen = 0;
@@ -108,7 +166,7 @@ void TCommHandlerUdoSl::SendRequest()
   else                          metalen = 1;
 
 	crc = 0;
-  rwbuflen = 0;
+  txbuflen = 0;
 
   // 1. the sync byte
   b = 0x55; // sync
@@ -160,53 +218,39 @@ void TCommHandlerUdoSl::SendRequest()
 
 	// send the request
 
-	r = comm.Write(&rwbuf[0], rwbuflen);
-	if ((r <= 0) or (r != int(rwbuflen)))
+	r = comm.Write(&txbuf[0], txbuflen);
+	if ((r <= 0) or (r != int(txbuflen)))
 	{
-    throw EUdoAbort(UDOERR_CONNECTION, "%s: send error", opstring);
+    throw EUdoAbort(UDOERR_CONNECTION, "%s: send error", OpString());
 	}
 }
 
 void TCommHandlerUdoSl::RecvResponse()
 {
 	int       r;
-	uint8_t   lencode;
-	uint32_t  offslen;
-	uint32_t  metalen;
-	uint16_t  ecode;
-	bool      iserror = false;
+	nstime_t  timeout_ns = nstime_t(timeout * 1000000000);
 
 	// receive the response
 
-	rwbuflen = 0;
-	rwbuf_ansdatapos = 0;
-
-  rxreadpos = 0;
-  rxstate = 0;
-  rxcnt = 0;
-  crc = 0;
-  ans_datalen = 0;
-
-  ans_offset   = 0;
-  ans_metadata = 0;
-  ans_index    = 0;
-
-	lastrecvtime = nstime();
+	StartRecv();
 
   while (true)
   {
-  	r = comm.Read(&rwbuf[rwbuflen], sizeof(rwbuf) - rwbuflen);
+  	r = comm.Read(&rwbuf[rwbuflen], RxReadLen());
   	if (r <= 0)
   	{
   		if (r == -EAGAIN)
   		{
-  			if (nstime() - lastrecvtime > timeout * 1000000000)
+  			// sleep until some data arrives instead of spinning on the Read()
+  			nstime_t remaining = lastrecvtime + timeout_ns - nstime();
+  			if (remaining <= 0)
   			{
-  				throw EUdoAbort(UDOERR_TIMEOUT, "%s timeout", opstring);
+  				throw EUdoAbort(UDOERR_TIMEOUT, "%s timeout", OpString());
   			}
+  			comm.WaitForRx(int((remaining + 999999) / 1000000));
   			continue;
   		}
-  		throw EUdoAbort(UDOERR_TIMEOUT, "%s response read error: %d", opstring, r);
+  		throw EUdoAbort(UDOERR_TIMEOUT, "%s response read error: %d", OpString(), r);
   	}
 
   	lastrecvtime = nstime();
@@ -219,169 +263,479 @@ void TCommHandlerUdoSl::RecvResponse()
 
   	rwbuflen += r;
 
-  	while (rxreadpos < int(rwbuflen))
+  	// process all the complete frames, the answers of earlier (timed out) requests are skipped
+  	while (true)
   	{
-			uint8_t b = rwbuf[rxreadpos];
-
-			if ((rxstate > 0) && (rxstate < 10))
-			{
-				crc = udo_calc_crc(crc, b);
-			}
-
-			if (0 == rxstate)  // waiting for the sync byte
-			{
-				if (0x55 == b)
-				{
-					crc = udo_calc_crc(0, b); // start the CRC from zero
-					rxstate = 1;
-				}
-			}
-			else if (1 == rxstate) // command and lengths
-			{
-        if (((b & 0x80) != 0) != iswrite)  // does the response R/W differ from the request ?
-				{
-          rxstate = 0;
-				}
-        else
-        {
-          // decode the length fields
-          offslen = (0x4210 >> ((b & 3) << 2)) & 0xF;
-          metalen = (0x4210 >> (b & 0xC)) & 0xF;  // its already multiple by 4
-
-          rxcnt = 0;
-          rxstate = 3;  // index follows normally
-
-          lencode = ((b >> 4) & 7);
-          if      (lencode < 5)   ans_datalen = ((0x84210 >> (lencode << 2)) & 0xF); // in-line demultiplexing
-          else if (5 == lencode)  ans_datalen = 16;
-          else if (7 == lencode)  rxstate = 2;     // extended length follows
-          else  // 6 == error code
-          {
-            ans_datalen = 2;
-            iserror = true;
-          }
-        }
-			}
-			else if (2 == rxstate) // extended length
-			{
-				if (0 == rxcnt)
-				{
-					ans_datalen = b; // low byte
-					rxcnt = 1;
-				}
-				else
-				{
-					ans_datalen |= (b << 8); // high byte
-					rxcnt = 0;
-					rxstate = 3; // index follows
-				}
-			}
-			else if (3 == rxstate) // index
-			{
-				if (0 == rxcnt)
-				{
-					ans_index = b;  // index low
-					rxcnt = 1;
-				}
-				else
-				{
-					ans_index |= (b << 8);  // index high
-					rxcnt = 0;
-  				if (offslen > 0)
-  				{
-  					rxstate = 4;  // offset follows
-  				}
-  				else if (metalen > 0)
-  				{
-  					rxstate = 5;  // meta follows
-  				}
-  				else if (ans_datalen > 0)
-  				{
-            rxstate = 6;  // read data or error code
-  				}
-          else
-          {
-            rxstate = 10;  // then crc check
-          }
-				}
-			}
-  		else if (4 == rxstate) // offset
+  		try
   		{
-        ans_offset |= (b << (rxcnt << 3));
-  			++rxcnt;
-  			if (rxcnt >= offslen)
+  			if (!ProcessRxBytes())
   			{
-          rxcnt = 0;
-  				if (metalen > 0)
-  				{
-  					rxstate = 5;  // meta follows
-  				}
-  				else if (ans_datalen > 0)
-  				{
-            rxstate = 6;  // read data or error code
-  				}
-          else
-          {
-            rxstate = 10;  // then crc check
-          }
+  				break;  // more data needed
   			}
-  		}
-  		else if (5 == rxstate) // metadata
-  		{
-        ans_metadata |= (b << (rxcnt << 3));
-  			++rxcnt;
-  			if (rxcnt >= metalen)
+  			if (AnswerMatches())
   			{
-          rxcnt = 0;
-  				if (ans_datalen > 0)
-  				{
-            rxstate = 6;  // read data or error code
-  				}
-          else
-          {
-            rxstate = 10;  // then crc check
-          }
+  				return;  // --> everything is ok, return to the caller
   			}
   		}
-  		else if (6 == rxstate) // read data (or error code)
+  		catch (EUdoAbort & e)
   		{
-        if (0 == rxcnt)  // save the answer data start position
-        {
-          rwbuf_ansdatapos = rxreadpos;
-        }
-
-        // just count the bytes, the rwbuf_ansdatapos points to its start
-  			++rxcnt;
-  			if (rxcnt >= ans_datalen)
+  			if ((UDOERR_CRC == e.ecode) || AnswerMatches())
   			{
-  				rxstate = 10;
+  				throw;
   			}
   		}
-  		else if (10 == rxstate) // crc check
-  		{
-  			if (b != crc)
-  			{
-          throw EUdoAbort(UDOERR_CRC, "%s CRC error", opstring);
-  			}
-  			else  // CRC OK
-  			{
-  				if (iserror)
-  				{
-            ecode = *(uint16_t *)&rwbuf[rwbuf_ansdatapos];
-            throw EUdoAbort(ecode, "%s result: %.4X", opstring, ecode);
-  				}
-          else
+  	}
+  }
+}
+
+bool TCommHandlerUdoSl::AnswerMatches()
+{
+	return (ans_iswrite == iswrite) && (ans_index == mindex) && (ans_offset == moffset);
+}
+
+void TCommHandlerUdoSl::StartRecv()
+{
+	rwbuflen = 0;
+	rwbuf_ansdatapos = 0;
+
+  rxreadpos = 0;
+  rxstate = 0;
+  rxneeded = 0;
+  crc = 0;
+  ans_datalen = 0;
+  rx_iserror = false;
+
+  ans_offset   = 0;
+  ans_metadata = 0;
+  ans_index    = 0;
+
+	lastrecvtime = nstime();
+}
+
+bool TCommHandlerUdoSl::ProcessRxBytes()
+{
+  uint16_t  ecode;
+
+  while (true)
+  {
+    if (0 == rxstate)  // searching for the sync byte
+    {
+      uint8_t * psync = (uint8_t *)memchr(&rwbuf[rxreadpos], 0x55, rwbuflen - rxreadpos);
+      if (!psync)
+      {
+        rwbuflen = 0;  // drop the garbage
+        rxreadpos = 0;
+        rxneeded = 0;
+        return false;
+      }
+      rxreadpos = psync - &rwbuf[0];
+      rxstate = 1;
+    }
+
+    // the header length depends on the command byte (and on the extended length)
+    uint8_t * pframe = &rwbuf[rxreadpos];
+    int       avail  = rwbuflen - rxreadpos;
+    if (avail < 2)
+    {
+      rxneeded = 2 - avail;
+      return false;
+    }
+
+    uint8_t cmd = pframe[1];
+    ans_iswrite = ((cmd & 0x80) != 0);  // matched together with the index and offset
+
+    unsigned offslen = (0x4210 >> ((cmd & 3) << 2)) & 0xF;
+    unsigned metalen = (0x4210 >> (cmd & 0xC)) & 0xF;  // its already multiple by 4
+    unsigned hdrlen  = 4 + offslen + metalen;  // sync, cmd, index, offset, metadata
+
+    rx_iserror = false;
+    unsigned lencode = ((cmd >> 4) & 7);
+    if      (lencode < 5)   ans_datalen = ((0x84210 >> (lencode << 2)) & 0xF); // in-line demultiplexing
+    else if (5 == lencode)  ans_datalen = 16;
+    else if (6 == lencode)  // error code
+    {
+      ans_datalen = 2;
+      rx_iserror = true;
+    }
+    else  // 7: extended length follows
+    {
+      hdrlen += 2;
+      if (avail < 4)
+      {
+        rxneeded = 4 - avail;
+        return false;
+      }
+      ans_datalen = pframe[2] | (pframe[3] << 8);
+      if (ans_datalen > UDO_MAX_PAYLOAD_LEN)
+      {
+        ++rxreadpos;  // can not be a valid response, search for the next sync
+        rxstate = 0;
+        continue;
+      }
+    }
+
+    // now the frame length is known
+    int framelen = hdrlen + ans_datalen + 1;  // + crc
+    if (rxreadpos + framelen > int(sizeof(rwbuf)))
+    {
+      // move the partial frame to the buffer start
+      memmove(&rwbuf[0], pframe, avail);
+      rwbuflen = avail;
+      rxreadpos = 0;
+      pframe = &rwbuf[0];
+    }
+
+    if (avail < framelen)
+    {
+      rxneeded = framelen - avail;
+      return false;
+    }
+
+    // the complete frame is here
+    rxneeded = 0;
+    rxstate = 0;
+    rxreadpos += framelen;
+
+    crc = udo_calc_crc_block(0, pframe, framelen - 1);
+    if (crc != pframe[framelen - 1])
+    {
+      throw EUdoAbort(UDOERR_CRC, "%s CRC error", OpString());
+    }
+
+    uint8_t * pfield = pframe + hdrlen - offslen - metalen - 2;
+    ans_index = pfield[0] | (pfield[1] << 8);
+    pfield += 2;
+    ans_offset = 0;
+    memcpy(&ans_offset, pfield, offslen);  // little endian
+    pfield += offslen;
+    ans_metadata = 0;
+    memcpy(&ans_metadata, pfield, metalen);
+
+    rwbuf_ansdatapos = pframe + hdrlen - &rwbuf[0];
+
+    if (rx_iserror)
+    {
+      ecode = *(uint16_t *)&rwbuf[rwbuf_ansdatapos];
+      throw EUdoAbort(ecode, "%s result: %.4X", OpString(), ecode);
+    }
+
+    return true;  // --> everything is ok
+  }
+}
+
+int TCommHandlerUdoSl::RxReadLen()
+{
+  if (rxreadpos > int(sizeof(rwbuf) / 2))  // make room for the following (pipelined) answers
+  {
+    memmove(&rwbuf[0], &rwbuf[rxreadpos], rwbuflen - rxreadpos);
+    rwbuflen -= rxreadpos;
+    rxreadpos = 0;
+  }
+
+  int len = sizeof(rwbuf) - rwbuflen;
+  if ((rxneeded > 0) && (rxneeded < len) && (inflight_count <= 1))
+  {
+    len = rxneeded;  // the exact remaining length of the frame
+  }
+  return len;
+}
+
+void TCommHandlerUdoSl::UdoTransactions(TUdoTransaction * atra, unsigned acount, bool astop_on_short)
+{
+  if ((max_inflight <= 1) && !Busy())
+  {
+    super::UdoTransactions(atra, acount, astop_on_short);  // one by one
+    return;
+  }
+
+  // pipelined mode: keep the window filled, the answers arrive in the sending order
+
+  unsigned   n;
+  unsigned   nextsend = 0;   // the next transaction to send
+  unsigned   firstopen = 0;  // all transactions before this are completed
+  bool       stopsend = false;
+
+  for (n = 0; n < acount; ++n)
+  {
+    atra[n].completed = false;
+    atra[n].oncomplete = nullptr;
+  }
+
+  while (true)
+  {
+    // the queued asynchronous transactions were submitted earlier, they go first
+    StartNextTransaction();
+    while (!stopsend && !queue_first && (nextsend < acount) && !WindowFull(&atra[nextsend]))
+    {
+      StartTransaction(&atra[nextsend]);
+      ++nextsend;
+    }
+
+    while ((firstopen < nextsend) && atra[firstopen].completed)
+    {
+      TUdoTransaction * tra = &atra[firstopen];
+      if (astop_on_short && (tra->result || (!tra->iswrite && (tra->anslen < int(tra->rqlen)))))
+      {
+        stopsend = true;
+      }
+      ++firstopen;
+    }
+
+    if ((firstopen >= nextsend) && (stopsend || (nextsend >= acount)))
+    {
+      completion_count -= nextsend;  // these were not submitted, the Poll() does not report them
+      return;  // everything was processed
+    }
+
+    Progress(100);  // the callbacks of the queued transactions run at the user's Poll()
+  }
+}
+
+void TCommHandlerUdoSl::SubmitTransaction(TUdoTransaction * atra)
+{
+  atra->completed = false;
+  QueueTransaction(atra);
+  StartNextTransaction();
+}
+
+void TCommHandlerUdoSl::Progress(int atimeout_ms)
+{
+  int r;
+  int startcount = completion_count;
+
+  nstime_t deadline = nstime() + nstime_t(atimeout_ms) * 1000000;
+  nstime_t timeout_ns = nstime_t(timeout * 1000000000);
+
+  StartNextTransaction();
+
+  while (inflight_first)
+  {
+    r = comm.Read(&rwbuf[rwbuflen], RxReadLen());
+    if (r > 0)
+    {
+      lastrecvtime = nstime();
+      rwbuflen += r;
+
+      // process all the complete answers in the buffer
+      while (inflight_first)
+      {
+        try
+        {
+          if (!ProcessRxBytes())
           {
-    				return;  // --> everything is ok, return to the caller
+            break;
           }
-  			}
-  		}
+          if (MatchAnswer())
+          {
+            FinishTransaction(0);
+          }
+        }
+        catch (EUdoAbort & e)
+        {
+          if ((UDOERR_CRC == e.ecode) || MatchAnswer())
+          {
+            FinishTransaction(e.ecode);
+          }
+        }
+      }
+      continue;
+    }
+
+    if (r != -EAGAIN)
+    {
+      AbortInflight(UDOERR_CONNECTION);
+      StartNextTransaction();
+      continue;
+    }
+
+    nstime_t t = nstime();
+    if (t - lastrecvtime > timeout_ns)
+    {
+      // the answers come in order: when the oldest is missing, the later ones are lost too
+      AbortInflight(UDOERR_TIMEOUT);
+      StartNextTransaction();
+      continue;
+    }
+
+    if ((completion_count > startcount) || (t >= deadline))
+    {
+      break;
+    }
+
+    // wait for more data
+    nstime_t waittime = lastrecvtime + timeout_ns - t;
+    if (waittime > deadline - t)  waittime = deadline - t;
+    comm.WaitForRx(int((waittime + 999999) / 1000000));
+  }
+}
 
-			++rxreadpos;
-  	}
+int TCommHandlerUdoSl::PollFd()
+{
+#ifdef WIN32
+  return -1;
+#else
+  return comm.comfd;
+#endif
+}
+
+bool TCommHandlerUdoSl::Busy()
+{
+  return (queue_first || inflight_first);
+}
+
+void TCommHandlerUdoSl::LoadTransaction(TUdoTransaction * tra)
+{
+  iswrite   = tra->iswrite;
+  mindex    = tra->index;
+  moffset   = tra->offset;
+  mmetadata = tra->metadata;
+  mdataptr  = tra->dataptr;
+  mrqlen    = tra->rqlen;
+}
+
+static inline unsigned udosl_frame_estimate(TUdoTransaction * tra)  // upper limit of the request frame length
+{
+  return 16 + (tra->iswrite ? tra->rqlen : 0);
+}
+
+bool TCommHandlerUdoSl::WindowFull(TUdoTransaction * tra)
+{
+  if (!inflight_first)
+  {
+    return false;  // one is always allowed
+  }
+
+  unsigned window = (max_inflight > 1 ? max_inflight : 1);
+  if (inflight_count >= window)
+  {
+    return true;
+  }
+
+  return (inflight_bytes + udosl_frame_estimate(tra) > max_inflight_bytes);
+}
+
+void TCommHandlerUdoSl::StartNextTransaction()
+{
+  while (queue_first && !WindowFull(queue_first))
+  {
+    StartTransaction(DequeueTransaction());
   }
 }
 
+bool TCommHandlerUdoSl::StartTransaction(TUdoTransaction * tra)
+{
+  tra->result = 0;
+  tra->anslen = 0;
+
+  if (tra->iswrite && (tra->rqlen > UDO_MAX_PAYLOAD_LEN))
+  {
+    CompleteTransaction(tra, UDOERR_DATA_TOO_BIG);
+    return false;
+  }
+
+  LoadTransaction(tra);
+  try
+  {
+    SendRequest();
+  }
+  catch (EUdoAbort & e)
+  {
+    if (inflight_first)  LoadTransaction(inflight_first);
+    CompleteTransaction(tra, e.ecode);
+    return false;
+  }
+
+  if (!inflight_first)
+  {
+    StartRecv();
+  }
+
+  tra->sendtime = nstime();
+
+  // append to the in-flight list
+  tra->next = nullptr;
+  if (inflight_last)
+  {
+    inflight_last->next = tra;
+  }
+  else
+  {
+    inflight_first = tra;
+  }
+  inflight_last = tra;
+  ++inflight_count;
+  inflight_bytes += udosl_frame_estimate(tra);
+
+  LoadTransaction(inflight_first);  // the answer processing works with the oldest one
+  return true;
+}
+
+bool TCommHandlerUdoSl::MatchAnswer()
+{
+  // the answers arrive in order, when it belongs to a later transaction, the earlier answers were lost
+  TUdoTransaction * tra = inflight_first;
+  while (tra && ((tra->iswrite != ans_iswrite) || (tra->index != ans_index) || (tra->offset != ans_offset)))
+  {
+    tra = tra->next;
+  }
+
+  if (!tra)
+  {
+    return false;  // unexpected answer, ignored
+  }
+
+  while (inflight_first != tra)
+  {
+    FinishTransaction(UDOERR_TIMEOUT);
+  }
+  return true;
+}
+
+void TCommHandlerUdoSl::FinishTransaction(uint16_t aresult)
+{
+  TUdoTransaction * tra = inflight_first;
+  inflight_first = tra->next;
+  if (!inflight_first)  inflight_last = nullptr;
+  tra->next = nullptr;
+  --inflight_count;
+  inflight_bytes -= udosl_frame_estimate(tra);
+
+  if (!aresult && !tra->iswrite && (ans_datalen > 0))
+  {
+    if (ans_datalen > int(tra->rqlen))
+    {
+      aresult = UDOERR_DATA_TOO_BIG;
+    }
+    else
+    {
+      memcpy(tra->dataptr, &rwbuf[rwbuf_ansdatapos], ans_datalen);
+      tra->anslen = ans_datalen;
+    }
+  }
+
+  if (inflight_first)
+  {
+    LoadTransaction(inflight_first);
+  }
+
+  CompleteTransaction(tra, aresult);
+  StartNextTransaction();
+}
+
+void TCommHandlerUdoSl::AbortInflight(uint16_t aresult)
+{
+  while (inflight_first)
+  {
+    TUdoTransaction * tra = inflight_first;
+    inflight_first = tra->next;
+    tra->next = nullptr;
+    CompleteTransaction(tra, aresult);
+  }
+  inflight_last = nullptr;
+  inflight_count = 0;
+  inflight_bytes = 0;
+}
+
 int TCommHandlerUdoSl::AddTx(void * asrc, int len)
 {
   unsigned available = TxAvailable();
@@ -392,21 +746,14 @@ int TCommHandlerUdoSl::AddTx(void * asrc, int len)
 
   if (len > available)  len = available;
 
-  uint8_t * srcp = (uint8_t *)asrc;
-  uint8_t * dstp = &rwbuf[rwbuflen];
-  uint8_t * endp = dstp + len;
-  while (dstp < endp)
-  {
-    uint8_t b = *srcp++;
-    *dstp++ = b;
-    crc = udo_calc_crc(crc, b);
-  }
+  memcpy(&txbuf[txbuflen], asrc, len);
+  crc = udo_calc_crc_block(crc, &txbuf[txbuflen], len);
 
-  rwbuflen += len;
+  txbuflen += len;
   return len;
 }
 
 int TCommHandlerUdoSl::TxAvailable()
 {
-	return (sizeof(rwbuf) - rwbuflen);
+	return (sizeof(txbuf) - txbuflen);
 }
@@ -27,6 +27,10 @@ public:
 	string     devstr;
 	TSerComm   comm;
 
+	// pipelining (max_inflight > 1): the slaves answer in order, the request bytes sent ahead
+	// are limited to not overflow the slave receive buffer (UARTCOMM_RXBUF_SIZE)
+	unsigned   max_inflight_bytes = 512;
+
 	TCommHandlerUdoSl();
 	virtual ~TCommHandlerUdoSl();
 
@@ -39,14 +43,28 @@ public:
 	virtual int        UdoRead(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen);
 	virtual void       UdoWrite(uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen);
 
+	virtual void       UdoTransactions(TUdoTransaction * atra, unsigned acount, bool astop_on_short);
+
+	virtual void       SubmitTransaction(TUdoTransaction * atra);
+	virtual int        PollFd();
+	virtual bool       Busy();
+
 protected:
   int        rxreadpos = 0;
-  int        rxcnt = 0;
-  int        rxstate = 0;
+  int        rxneeded = 0;   // missing bytes of the current frame, 0 = unknown
+  int        rxstate = 0;    // 0 = searching for the sync byte, 1 = frame started
   uint8_t    crc = 0;
   nstime_t   lastrecvtime = 0;
 
-  string     opstring;
+  bool       rx_iserror = false;
+
+  TUdoTransaction *  inflight_first = nullptr;  // sent, waiting for the answer, the answers arrive in this order
+  TUdoTransaction *  inflight_last = nullptr;
+  unsigned           inflight_count = 0;
+  unsigned           inflight_bytes = 0;    // request frame bytes of the in-flight transactions
+
+  char       opstrbuf[64];
+  const char * OpString();  // formats the current operation for the error messages only
   bool       iswrite = false;
   uint16_t   mindex = 0;
   uint32_t   moffset = 0;
@@ -54,6 +72,7 @@ protected:
   uint32_t   mrqlen = 0;
   uint8_t *  mdataptr = nullptr;
 
+  bool       ans_iswrite = false;
   uint32_t   ans_index = 0;
   uint32_t   ans_offset = 0;
   uint32_t   ans_metadata = 0;
@@ -62,10 +81,26 @@ protected:
   int        rwbuf_ansdatapos = 0;  // the start of the answer data in the rwbuf (answer phase)
 
   uint32_t   rwbuflen = 0;
-  uint8_t    rwbuf[UDOSL_MAX_RQ_SIZE - 1];
+  uint8_t    rwbuf[UDOSL_MAX_RQ_SIZE - 1];  // receive buffer, might contain more answers
+
+  uint32_t   txbuflen = 0;
+  uint8_t    txbuf[UDOSL_MAX_RQ_SIZE];  // request frame, separate so that it can be sent during the receive
 
   void       SendRequest();
   void       RecvResponse();
+  void       StartRecv();
+  bool       ProcessRxBytes();  // returns true when the complete response is received
+  int        RxReadLen();       // how many bytes to read from the device
+
+  void       LoadTransaction(TUdoTransaction * tra);  // sets the request context (mindex, ...)
+  void       StartNextTransaction();  // fills the pipelining window from the queue
+  bool       StartTransaction(TUdoTransaction * tra);
+  bool       WindowFull(TUdoTransaction * tra);
+  void       FinishTransaction(uint16_t aresult);  // completes the oldest in-flight transaction
+  bool       MatchAnswer();  // drops the transactions whose answer was lost, false = unexpected answer
+  bool       AnswerMatches();  // the received answer belongs to the current request (R/W, index, offset)
+  void       AbortInflight(uint16_t aresult);
+  virtual void Progress(int atimeout_ms);
 
   int        AddTx(void * asrc, int len);
   int        TxAvailable();
@@ -69,6 +69,173 @@ void TUdoCommHandler::UdoWrite(uint16_t index, uint32_t offset, void * dataptr,
 	throw EUdoAbort(UDOERR_APPLICATION, "Open: Invalid comm. handler");
 }
 
+void TUdoCommHandler::UdoTransactions(TUdoTransaction * atra, unsigned acount, bool astop_on_short)
+{
+  // default implementation: one after the other, the pipelining handlers override this
+
+  TUdoTransaction * tra = atra;
+  TUdoTransaction * endtra = atra + acount;
+  for (; tra < endtra; ++tra)
+  {
+    tra->completed = false;
+  }
+
+  for (tra = atra; tra < endtra; ++tra)
+  {
+    ExecTransaction(tra);
+    tra->completed = true;
+
+    if (astop_on_short && (tra->result || (!tra->iswrite && (tra->anslen < int(tra->rqlen)))))
+    {
+      break;
+    }
+  }
+}
+
+int TUdoCommHandler::UdoMultiRead(TUdoMultiReadItem * items, unsigned count, void * dataptr, uint32_t maxdatalen)
+{
+  // generic form: store the list into the device then read the answers
+  UdoWrite(0x0003, 0, items, count * sizeof(TUdoMultiReadItem));
+  return UdoRead(0x0003, 0, dataptr, maxdatalen);
+}
+
+void TUdoCommHandler::ExecTransaction(TUdoTransaction * atra)
+{
+  atra->result = 0;
+  atra->anslen = 0;
+  exec_metadata = atra->metadata;  // sent by the handler
+  try
+  {
+    if (atra->iswrite)
+    {
+      UdoWrite(atra->index, atra->offset, atra->dataptr, atra->rqlen);
+    }
+    else
+    {
+      atra->anslen = UdoRead(atra->index, atra->offset, atra->dataptr, atra->rqlen);
+    }
+  }
+  catch (EUdoAbort & e)
+  {
+    atra->result = e.ecode;
+  }
+  exec_metadata = 0;
+}
+
+void TUdoCommHandler::ExecQueued(TUdoTransaction * atra)
+{
+  atra->oncomplete = nullptr;
+  SubmitTransaction(atra);
+  WaitCompletion(atra);
+  --completion_count;  // not a submitted transaction
+}
+
+void TUdoCommHandler::WaitCompletion(TUdoTransaction * atra)
+{
+  while (!atra->completed)
+  {
+    Progress(100);  // the callbacks and the completion count are left for the user's Poll()
+  }
+}
+
+void TUdoCommHandler::SubmitTransaction(TUdoTransaction * atra) // virtual
+{
+  // default implementation: synchronous execution, the completion will be reported at the next Poll()
+  atra->completed = false;
+  ExecTransaction(atra);
+  CompleteTransaction(atra, atra->result);
+}
+
+int TUdoCommHandler::Poll(int atimeout_ms) // virtual
+{
+  // the already completed transactions are reported without waiting
+  Progress(completion_count > 0 ? 0 : atimeout_ms);
+  return DispatchCompletions();
+}
+
+void TUdoCommHandler::Progress(int atimeout_ms) // virtual
+{
+  (void)atimeout_ms;  // the default handler executes synchronously, nothing to wait for
+}
+
+int TUdoCommHandler::PollFd() // virtual
+{
+  return -1;
+}
+
+bool TUdoCommHandler::Busy() // virtual
+{
+  return (queue_first != nullptr);
+}
+
+void TUdoCommHandler::QueueTransaction(TUdoTransaction * atra)
+{
+  atra->next = nullptr;
+  if (queue_last)
+  {
+    queue_last->next = atra;
+  }
+  else
+  {
+    queue_first = atra;
+  }
+  queue_last = atra;
+}
+
+TUdoTransaction * TUdoCommHandler::DequeueTransaction()
+{
+  TUdoTransaction * result = queue_first;
+  if (result)
+  {
+    queue_first = result->next;
+    if (!queue_first)  queue_last = nullptr;
+    result->next = nullptr;
+  }
+  return result;
+}
+
+void TUdoCommHandler::CompleteTransaction(TUdoTransaction * atra, uint16_t aresult)
+{
+  atra->result = aresult;
+  atra->completed = true;
+  ++completion_count;
+
+  if (atra->oncomplete)
+  {
+    // the callback runs from the next Poll(), so it can safely submit new transactions
+    atra->next = nullptr;
+    if (done_last)
+    {
+      done_last->next = atra;
+    }
+    else
+    {
+      done_first = atra;
+    }
+    done_last = atra;
+  }
+}
+
+int TUdoCommHandler::DispatchCompletions()
+{
+  // the callbacks might complete new transactions (default handler), those go to the next Poll()
+  TUdoTransaction * tra = done_first;
+  done_first = nullptr;
+  done_last = nullptr;
+
+  while (tra)
+  {
+    TUdoTransaction * next = tra->next;
+    tra->next = nullptr;
+    (*tra->oncomplete)(tra);  // the record might be resubmitted here
+    tra = next;
+  }
+
+  int result = completion_count;
+  completion_count = 0;
+  return result;
+}
+
 //-----------------------------------------------------------------------------
 // TUdoComm
 //-----------------------------------------------------------------------------
@@ -77,6 +244,11 @@ TUdoComm::TUdoComm()
 {
   commh = &commh_none;
   max_payload_size = 64;  // start with the smallest
+
+  for (unsigned n = 0; n < UDO_PREFETCH_MAX; ++n)
+  {
+    pftra[n].completed = true;  // free for the read-ahead
+  }
 }
 
 TUdoComm::~TUdoComm()
@@ -113,6 +285,11 @@ void TUdoComm::Open()
     throw EUdoAbort(UDOERR_CONNECTION, "Invalid Obj-0000 response: %.8X", d32);
 	}
 
+  multiread_supported = true;
+  objdesc_supported = true;
+  ClearCache();  // it might be a different device now
+  PrefetchDrop();
+
   r = commh->UdoRead(0x0001, 0, &d32, 4);  // get the maximal payload length
   if ((d32 < 64) or (d32 > UDO_MAX_PAYLOAD_LEN))
   {
@@ -121,6 +298,26 @@ void TUdoComm::Open()
   }
 
   max_payload_size = d32;
+  commh->max_payload = max_payload_size;
+
+  if (commh->max_payload_ext > max_payload_size)  // try the large payload
+  {
+    try
+    {
+      r = commh->UdoRead(0x0005, 0, &d32, 4);
+      if ((4 == r) && (d32 > max_payload_size))
+      {
+        if (d32 > commh->max_payload_ext)  d32 = commh->max_payload_ext;
+        if (d32 > 0xFFFF)  d32 = 0xFFFF;
+        max_payload_size = d32;
+        commh->max_payload = max_payload_size;
+      }
+    }
+    catch (EUdoAbort & e)
+    {
+      // not supported, the normal payload size remains
+    }
+  }
 }
 
 void TUdoComm::Close()
@@ -135,69 +332,714 @@ bool TUdoComm::Opened()
 
 int TUdoComm::UdoRead(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen)
 {
-	int result = commh->UdoRead(index, offset, dataptr, maxdatalen);
+	int result;
+	if (cache_enabled and CacheGet(index, offset, dataptr, maxdatalen, &result))
+	{
+		return result;
+	}
+
+	result = commh->UdoRead(index, offset, dataptr, maxdatalen);
   if ((result <= 8) and (result < maxdatalen))
   {
     uint8_t * pdata = (uint8_t *)dataptr;
     memset(pdata + result, 0, maxdatalen - result); // pad smaller responses, todo: sign extension
   }
+
+  if (cache_enabled)
+  {
+  	CachePut(index, offset, dataptr, maxdatalen, result);
+  }
   return result;
 }
 
 void TUdoComm::UdoWrite(uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen)
 {
+	if (cache_enabled)  InvalidateCache(index);  // before the write: a failed write might have changed the value too
+	if (pf_count && (index == pf_index))  PrefetchDrop();
+
 	commh->UdoWrite(index, offset, dataptr, datalen);
 }
 
+void TUdoComm::SubmitRead(TUdoTransaction * atra, uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen,
+                          PUdoCompletionFunc aoncomplete, void * auserdata)
+{
+  atra->iswrite    = false;
+  atra->index      = index;
+  atra->offset     = offset;
+  atra->metadata   = 0;
+  atra->rqlen      = maxdatalen;
+  atra->dataptr    = (uint8_t *)dataptr;
+  atra->oncomplete = aoncomplete;
+  atra->userdata   = auserdata;
+
+  commh->SubmitTransaction(atra);
+}
+
+void TUdoComm::SubmitWrite(TUdoTransaction * atra, uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen,
+                           PUdoCompletionFunc aoncomplete, void * auserdata)
+{
+  if (cache_enabled)  InvalidateCache(index);
+  if (pf_count && (index == pf_index))  PrefetchDrop();
+
+  atra->iswrite    = true;
+  atra->index      = index;
+  atra->offset     = offset;
+  atra->metadata   = 0;
+  atra->rqlen      = datalen;
+  atra->dataptr    = (uint8_t *)dataptr;
+  atra->oncomplete = aoncomplete;
+  atra->userdata   = auserdata;
+
+  commh->SubmitTransaction(atra);
+}
+
+int TUdoComm::Poll(int atimeout_ms)
+{
+  return commh->Poll(atimeout_ms);
+}
+
+int TUdoComm::PollFd()
+{
+  return commh->PollFd();
+}
+
+//-----------------------------------------------------------------------------
+// client side read cache
+
+static inline uint64_t udo_cache_key(uint16_t index, uint32_t offset, uint32_t len)
+{
+  return (uint64_t(index) << 48) | (uint64_t(len & 0xFFFF) << 32) | offset;
+}
+
+void TUdoComm::SetCachePolicy(uint16_t index, float attl)
+{
+  cache_policy[index] = attl;
+  InvalidateCache(index);
+}
+
+void TUdoComm::InvalidateCache(uint16_t index)
+{
+  auto first = cache.lower_bound(udo_cache_key(index, 0, 0));
+  auto last  = cache.upper_bound(udo_cache_key(index, 0xFFFFFFFF, 0xFFFF));  // no overflow at index 0xFFFF
+  cache.erase(first, last);
+}
+
+void TUdoComm::ClearCache()
+{
+  cache.clear();
+  cache_learned.clear();
+}
+
+float TUdoComm::CachePolicy(uint16_t index)
+{
+  auto it = cache_policy.find(index);
+  if (it != cache_policy.end())
+  {
+    return it->second;
+  }
+
+  it = cache_learned.find(index);
+  if (it != cache_learned.end())
+  {
+    return it->second;
+  }
+
+  if (!cache_learn or !objdesc_supported or (index < 0x0010))  // do not ask the base objects
+  {
+    return UDO_CACHE_NONE;
+  }
+
+  return LearnCachePolicy(index);
+}
+
+float TUdoComm::LearnCachePolicy(uint16_t index)
+{
+  float     result = UDO_CACHE_NONE;
+  uint32_t  desc = 0;
+
+  try
+  {
+    int r = commh->UdoRead(0x0004, index, &desc, 4);
+    if ((r == 4) and (desc & UDO_OBJDESC_CONST))
+    {
+      result = UDO_CACHE_FOREVER;
+    }
+  }
+  catch (EUdoAbort & e)
+  {
+    if (UDOERR_INDEX == e.ecode)
+    {
+      objdesc_supported = false;  // older device, do not ask again
+    }
+    else if (UDOERR_WRONG_OFFSET != e.ecode)
+    {
+      return UDO_CACHE_NONE;  // communication error: do not remember, the actual read will report it
+    }
+  }
+
+  cache_learned[index] = result;
+  return result;
+}
+
+bool TUdoComm::CacheGet(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen, int * rlen)
+{
+  if ((maxdatalen > 0xFFFF) or (CachePolicy(index) < 0))
+  {
+    return false;
+  }
+
+  auto it = cache.find(udo_cache_key(index, offset, maxdatalen));
+  if (it == cache.end())
+  {
+    ++cache_misses;
+    return false;
+  }
+
+  TUdoCacheEntry * pce = &it->second;
+  if (pce->expires and (nstime() >= pce->expires))
+  {
+    cache.erase(it);
+    ++cache_misses;
+    return false;
+  }
+
+  memcpy(dataptr, pce->data.data(), pce->data.size());
+  *rlen = pce->len;
+  ++cache_hits;
+  return true;
+}
+
+void TUdoComm::CachePut(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen, int alen)
+{
+  float ttl = CachePolicy(index);
+  if ((ttl < 0) or (maxdatalen > 0xFFFF))
+  {
+    return;
+  }
+
+  uint32_t storelen = ((alen <= 8) ? maxdatalen : alen);  // the small answers are padded by the UdoRead()
+
+  TUdoCacheEntry * pce = &cache[udo_cache_key(index, offset, maxdatalen)];
+  pce->expires = (ttl > 0 ? nstime() + nstime_t(ttl * 1000000000.0) : 0);
+  pce->len = alen;
+  pce->data.assign((uint8_t *)dataptr, (uint8_t *)dataptr + storelen);
+}
+
+void TUdoComm::ReadMany(TUdoTransaction * atra, unsigned acount)
+{
+  TUdoMultiReadItem  items[UDO_MULTIREAD_MAX_ITEMS];
+  uint8_t            ansbuf[UDO_MAX_PAYLOAD_LEN];
+  uint32_t           maxpayload = (max_payload_size < sizeof(ansbuf) ? max_payload_size : sizeof(ansbuf));
+
+  TUdoTransaction * endtra = atra + acount;
+  for (TUdoTransaction * tra = atra; tra < endtra; ++tra)
+  {
+    tra->iswrite = false;
+    tra->metadata = 0;
+    tra->anslen = 0;
+    tra->result = 0;
+    tra->completed = false;
+  }
+
+  unsigned maxitems = maxpayload / sizeof(TUdoMultiReadItem);  // the list must fit into a write request
+  if (maxitems > UDO_MULTIREAD_MAX_ITEMS)  maxitems = UDO_MULTIREAD_MAX_ITEMS;
+
+  TUdoTransaction * firsttra = atra;
+  while (firsttra < endtra)
+  {
+    if (!multiread_supported)
+    {
+      commh->UdoTransactions(firsttra, endtra - firsttra, false);
+      return;
+    }
+
+    // collect the items fitting into one answer
+    unsigned cnt = 0;
+    uint32_t anssize = 0;
+    while ((firsttra + cnt < endtra) && (cnt < maxitems))
+    {
+      TUdoTransaction * tra = firsttra + cnt;
+      uint32_t itemlen = tra->rqlen;
+      if (itemlen > maxpayload - sizeof(TUdoMultiReadAnsHead))
+      {
+        itemlen = maxpayload - sizeof(TUdoMultiReadAnsHead);
+      }
+      uint32_t itemsize = sizeof(TUdoMultiReadAnsHead) + ((itemlen + 3) & ~3);
+      if (anssize + itemsize > maxpayload)
+      {
+        break;
+      }
+
+      items[cnt].index  = tra->index;
+      items[cnt].len    = itemlen;
+      items[cnt].offset = tra->offset;
+      anssize += itemsize;
+      ++cnt;
+    }
+
+    int r;
+    try
+    {
+      r = commh->UdoMultiRead(&items[0], cnt, &ansbuf[0], anssize);
+    }
+    catch (EUdoAbort & e)
+    {
+      if (UDOERR_INDEX == e.ecode)  // older device, fall back to the single reads
+      {
+        multiread_supported = false;
+        continue;
+      }
+      throw;
+    }
+
+    // distribute the answers
+    int anspos = 0;
+    for (unsigned n = 0; n < cnt; ++n)
+    {
+      TUdoTransaction * tra = firsttra + n;
+      TUdoMultiReadAnsHead * phead = (TUdoMultiReadAnsHead *)&ansbuf[anspos];
+      if ((anspos + int(sizeof(TUdoMultiReadAnsHead)) > r)
+          || (anspos + int(sizeof(TUdoMultiReadAnsHead)) + phead->len > r)
+          || (phead->len > items[n].len))
+      {
+        // the rest is missing from the answer
+        for (; n < cnt; ++n)
+        {
+          firsttra[n].result = UDOERR_DATA_TOO_BIG;
+          firsttra[n].completed = true;
+        }
+        break;
+      }
+
+      if (phead->result)
+      {
+        tra->result = phead->result;
+      }
+      else
+      {
+        tra->anslen = phead->len;
+        memcpy(tra->dataptr, phead + 1, phead->len);
+      }
+      tra->completed = true;
+
+      anspos += sizeof(TUdoMultiReadAnsHead) + ((phead->len + 3) & ~3);
+    }
+
+    firsttra += cnt;
+  }
+}
+
 int TUdoComm::ReadBlob(uint16_t index, uint32_t offset, void *  dataptr, uint32_t maxdatalen)
 {
+  if (!prefetch_chunks)
+  {
+    return ReadBlobDirect(index, offset, dataptr, maxdatalen);
+  }
+
   int r;
+  bool sequential = ((index == seq_index) && (offset == seq_offset));
+
+  if (PrefetchRead(index, offset, dataptr, maxdatalen, &r))
+  {
+    ++prefetch_hits;
+  }
+  else
+  {
+    PrefetchDrop();  // its chunks were read before this, they might be outdated after it
+    r = ReadBlobDirect(index, offset, dataptr, maxdatalen);
+    if (sequential && (r == int(maxdatalen)))  // probably more will come
+    {
+      PrefetchStart(index, offset + r);
+    }
+  }
+
+  seq_index = index;
+  seq_offset = offset + r;
+  return r;
+}
+
+void TUdoComm::PrefetchDrop()
+{
+  pf_count = 0;  // the submitted reads still complete into the pf_buf
+}
+
+void TUdoComm::PrefetchStart(uint16_t index, uint32_t offset)
+{
+  // the records and the buffer can be reused only when the earlier reads are completed
+  for (unsigned n = 0; n < UDO_PREFETCH_MAX; ++n)
+  {
+    commh->WaitCompletion(&pftra[n]);
+  }
+
+  pf_slots = (prefetch_chunks < UDO_PREFETCH_MAX ? prefetch_chunks : UDO_PREFETCH_MAX);
+  pf_chunk = max_payload_size;
+  if (pf_buf.size() < pf_slots * pf_chunk)
+  {
+    pf_buf.resize(pf_slots * pf_chunk);
+  }
+
+  pf_index = index;
+  pf_offset = offset;
+  pf_first = 0;
+  pf_count = 0;
+  PrefetchFill();
+}
+
+void TUdoComm::PrefetchFill()
+{
+  while (pf_count < pf_slots)
+  {
+    unsigned last = (pf_first + pf_count + pf_slots - 1) % pf_slots;
+    if (pf_count && pftra[last].completed && (pftra[last].result || (pftra[last].anslen < int(pf_chunk))))
+    {
+      return;  // end of the object (or error), no more reads
+    }
+
+    unsigned pos = (pf_first + pf_count) % pf_slots;
+    SubmitRead(&pftra[pos], pf_index, pf_offset + pf_count * pf_chunk, &pf_buf[pos * pf_chunk], pf_chunk);
+    ++pf_count;
+  }
+}
+
+bool TUdoComm::PrefetchRead(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen, int * rlen)
+{
+  if (!pf_count || (index != pf_index) || (offset < pf_offset) || (offset >= pf_offset + pf_count * pf_chunk))
+  {
+    return false;
+  }
+
+  uint8_t * pdst = (uint8_t *)dataptr;
+  uint32_t  offs = offset;
+  uint32_t  remaining = maxdatalen;
+
+  while ((remaining > 0) && pf_count)
+  {
+    TUdoTransaction * tra = &pftra[pf_first];
+    commh->WaitCompletion(tra);
+
+    if (tra->result)  // the direct read will report the error
+    {
+      PrefetchDrop();
+      return false;
+    }
+
+    if (offs < pf_offset + tra->anslen)
+    {
+      uint32_t chunksize = pf_offset + tra->anslen - offs;
+      if (chunksize > remaining)  chunksize = remaining;
+      memcpy(pdst, tra->dataptr + (offs - pf_offset), chunksize);
+      pdst += chunksize;
+      offs += chunksize;
+      remaining -= chunksize;
+    }
+
+    if (tra->anslen < int(pf_chunk))  // end of the object (at the time of this read)
+    {
+      if (offs >= pf_offset + tra->anslen)
+      {
+        // consumed, the object might grow (like a log): the further reads go directly to the device
+        PrefetchDrop();
+        if (offs == offset)
+        {
+          return false;
+        }
+      }
+      break;
+    }
+
+    if (offs >= pf_offset + pf_chunk)  // the chunk is consumed, continue the read-ahead with it
+    {
+      pf_first = (pf_first + 1) % pf_slots;
+      pf_offset += pf_chunk;
+      --pf_count;
+      PrefetchFill();
+    }
+  }
+
+  *rlen = offs - offset;
+  return true;
+}
+
+int TUdoComm::ReadBlobDirect(uint16_t index, uint32_t offset, void *  dataptr, uint32_t maxdatalen)
+{
   int result = 0;
-  int remaining = maxdatalen;
+  uint32_t remaining = maxdatalen;
   uint8_t * pdata = (uint8_t *)dataptr;
   uint32_t offs = offset;
 
   while (remaining > 0)
   {
-    int chunksize = max_payload_size;
-    if (chunksize > remaining)  chunksize = remaining;
-    r = commh->UdoRead(index, offs, pdata, chunksize);
-    if (r <= 0)
+    // prepare a batch of chunk reads, the handler might send them pipelined
+    unsigned tracnt = 0;
+    while ((tracnt < UDO_BLOB_BATCH) && (remaining > 0))
     {
-      break;
+      uint32_t chunksize = max_payload_size;
+      if (chunksize > remaining)  chunksize = remaining;
+
+      TUdoTransaction * tra = &blobtra[tracnt];
+      tra->iswrite  = false;
+      tra->index    = index;
+      tra->offset   = offs;
+      tra->metadata = 0;
+      tra->rqlen    = chunksize;
+      tra->dataptr  = pdata;
+      tra->oncomplete = nullptr;
+
+      pdata  += chunksize;
+      offs   += chunksize;
+      remaining -= chunksize;
+      ++tracnt;
     }
 
-    result += r;
-    pdata  += r;
-    offs   += r;
-    remaining -= r;
+    commh->UdoTransactions(&blobtra[0], tracnt, true);
 
-    if (r < chunksize)
+    // evaluate the answers in order
+    for (unsigned n = 0; n < tracnt; ++n)
     {
-      break;
+      TUdoTransaction * tra = &blobtra[n];
+      if (!tra->completed)
+      {
+        return result;
+      }
+
+      if (tra->result)
+      {
+        throw EUdoAbort(tra->result, "ReadBlob(%.4X, %u) result: %.4X", index, tra->offset, tra->result);
+      }
+
+      if (tra->anslen <= 0)
+      {
+        return result;
+      }
+
+      result += tra->anslen;
+
+      if (tra->anslen < int(tra->rqlen))
+      {
+        return result;
+      }
     }
   }
 
   return result;
 }
 
-void TUdoComm::WriteBlob(uint16_t index, uint32_t offset, void *  dataptr, uint32_t datalen)
+void TUdoComm::WriteBlob(uint16_t index, uint32_t offset, void *  dataptr, uint32_t datalen, bool averify)
 {
-  int r;
-  int remaining = datalen;
+  uint32_t remaining = datalen;
   uint8_t * pdata = (uint8_t *)dataptr;
   uint32_t offs = offset;
 
+  if (cache_enabled)  InvalidateCache(index);
+  if (pf_count && (index == pf_index))  PrefetchDrop();
+
+  while (remaining > 0)
+  {
+    // prepare a batch of chunk writes, the pipelining handlers keep max_inflight of them
+    // on the way and resend only the lost ones
+    unsigned tracnt = 0;
+    while ((tracnt < UDO_BLOB_BATCH) && (remaining > 0))
+    {
+      uint32_t chunksize = max_payload_size;
+      if (chunksize > remaining)  chunksize = remaining;
+
+      TUdoTransaction * tra = &blobtra[tracnt];
+      tra->iswrite  = true;
+      tra->index    = index;
+      tra->offset   = offs;
+      tra->metadata = 0;
+      tra->rqlen    = chunksize;
+      tra->dataptr  = pdata;
+      tra->oncomplete = nullptr;
+
+      pdata  += chunksize;
+      offs   += chunksize;
+      remaining -= chunksize;
+      ++tracnt;
+    }
+
+    commh->UdoTransactions(&blobtra[0], tracnt, true);
+
+    // the first error in order is reported, the transactions after it are not sent
+    for (unsigned n = 0; n < tracnt; ++n)
+    {
+      TUdoTransaction * tra = &blobtra[n];
+      if (tra->completed && tra->result)
+      {
+        throw EUdoAbort(tra->result, "WriteBlob(%.4X, %u) result: %.4X", index, tra->offset, tra->result);
+      }
+    }
+  }
+
+  if (averify)
+  {
+    uint32_t devcrc = BlobCrc32(index, offset, datalen);
+    uint32_t crc = udo_calc_crc32(0, dataptr, datalen);
+    if (devcrc != crc)
+    {
+      throw EUdoAbort(UDOERR_WRITE_VALUE, "WriteBlob(%.4X, %u) verify: CRC32 %.8X, expected %.8X", index, offset, devcrc, crc);
+    }
+  }
+}
+
+uint32_t TUdoComm::BlobCrc32(uint16_t index, uint32_t offset, uint32_t length)
+{
+  // the device calculates the CRC32 of max. UDO_BLOBCRC_MAX_LEN bytes per request,
+  // the segment requests are sent in batches and their CRCs are combined
+  uint32_t  segcrc[UDO_BLOB_BATCH];
+  uint32_t  crc = 0;
+  uint32_t  remaining = length;
+  uint32_t  offs = offset;
+
   while (remaining > 0)
   {
-    int chunksize = max_payload_size;
-    if (chunksize > remaining)  chunksize = remaining;
-    commh->UdoWrite(index, offs, pdata, chunksize);
+    unsigned tracnt = 0;
+    while ((tracnt < UDO_BLOB_BATCH) && (remaining > 0))
+    {
+      uint32_t seglen = UDO_BLOBCRC_MAX_LEN;
+      if (seglen > remaining)  seglen = remaining;
+
+      TUdoTransaction * tra = &blobtra[tracnt];
+      tra->iswrite  = false;
+      tra->index    = 0x0006;
+      tra->offset   = offs;
+      tra->metadata = UDO_BLOBCRC_METADATA(index, seglen);
+      tra->rqlen    = 4;
+      tra->dataptr  = (uint8_t *)&segcrc[tracnt];
+      tra->oncomplete = nullptr;
+
+      offs   += seglen;
+      remaining -= seglen;
+      ++tracnt;
+    }
+
+    commh->UdoTransactions(&blobtra[0], tracnt, true);
+
+    for (unsigned n = 0; n < tracnt; ++n)
+    {
+      TUdoTransaction * tra = &blobtra[n];
+      if (tra->completed && tra->result)
+      {
+        throw EUdoAbort(tra->result, "BlobCrc32(%.4X, %u) result: %.4X", index, tra->offset, tra->result);
+      }
+      if (!tra->completed || (tra->anslen != 4))
+      {
+        throw EUdoAbort(UDOERR_WRONG_ACCESS, "BlobCrc32(%.4X, %u): invalid answer length %i", index, tra->offset, tra->anslen);
+      }
+
+      crc = udo_crc32_combine(crc, segcrc[n], tra->metadata >> 16);
+    }
+  }
+
+  return crc;
+}
+
+int TUdoComm::ReadScopePacked(uint16_t index, void * dataptr, uint32_t maxdatalen)
+{
+  uint8_t   chunk[UDO_MAX_PAYLOAD_LEN];
+  uint8_t   widths[256];
+  uint32_t  prev[256];
+  unsigned  hdrpos = 0;
+  unsigned  fieldcnt = 0;
+  unsigned  field = 0;
+  bool      hdrdone = false;
+  uint32_t  rawlen = 0;
+  uint32_t  varint = 0;
+  unsigned  varshift = 0;
+  uint32_t  result = 0;
+  uint8_t * pdst = (uint8_t *)dataptr;
+  uint32_t  offs = 0;
+
+  while (true)
+  {
+    // directly from the handler: the read cache must not serve the chunks of a previous capture
+    int r = commh->UdoRead(index, offs, &chunk[0], (max_payload_size < sizeof(chunk) ? max_payload_size : sizeof(chunk)));
+    if (r <= 0)
+    {
+      break;  // end of the packed data
+    }
+    offs += r;
+
+    for (int i = 0; i < r; ++i)
+    {
+      uint8_t b = chunk[i];
+
+      if (!hdrdone && (hdrpos < 2 + fieldcnt))
+      {
+        if (0 == hdrpos)
+        {
+          if (1 != b)
+          {
+            throw EUdoAbort(UDOERR_NOT_IMPLEMENTED, "ReadScopePacked(%.4X): unsupported version %u", index, b);
+          }
+        }
+        else if (1 == hdrpos)
+        {
+          fieldcnt = b;
+        }
+        else
+        {
+          if ((b != 1) && (b != 2) && (b != 4))
+          {
+            throw EUdoAbort(UDOERR_NOT_IMPLEMENTED, "ReadScopePacked(%.4X): invalid field width %u", index, b);
+          }
+          widths[hdrpos - 2] = b;
+        }
+        ++hdrpos;
+        continue;
+      }
 
-    pdata  += chunksize;
-    offs   += chunksize;
-    remaining -= chunksize;
+      // varint
+      varint |= (uint32_t(b & 0x7F) << varshift);
+      varshift += 7;
+      if (b & 0x80)
+      {
+        if (varshift > 28)
+        {
+          throw EUdoAbort(UDOERR_DATA_TOO_BIG, "ReadScopePacked(%.4X): invalid varint at %u", index, offs - r + i);
+        }
+        continue;
+      }
+      uint32_t value = varint;
+      varint = 0;
+      varshift = 0;
+
+      if (!hdrdone)  // the raw length closes the header
+      {
+        rawlen = value;
+        if (rawlen > maxdatalen)
+        {
+          throw EUdoAbort(UDOERR_DATA_TOO_BIG, "ReadScopePacked(%.4X): data too big: %u, buffer: %u", index, rawlen, maxdatalen);
+        }
+        memset(&prev[0], 0, sizeof(prev));
+        hdrdone = true;
+        continue;
+      }
+
+      unsigned width = widths[field];
+      if ((0 == fieldcnt) || (result + width > rawlen))
+      {
+        throw EUdoAbort(UDOERR_DATA_TOO_BIG, "ReadScopePacked(%.4X): more data than announced (%u)", index, rawlen);
+      }
+
+      // zigzag decoding, the sum is truncated to the field width
+      prev[field] += ((value >> 1) ^ (0 - (value & 1)));
+      memcpy(pdst + result, &prev[field], width);  // little endian
+      result += width;
+
+      if (++field >= fieldcnt)
+      {
+        field = 0;
+      }
+    }
   }
+
+  if (!hdrdone || (result != rawlen))
+  {
+    throw EUdoAbort(UDOERR_CONNECTION, "ReadScopePacked(%.4X): truncated data: %u of %u", index, result, rawlen);
+  }
+
+  return result;
 }
 
 int32_t TUdoComm::ReadI32(uint16_t index, uint32_t offset)
@@ -10,13 +10,23 @@
 
 #include "stdint.h"
 #include "udo.h"
+#include "nstime.h"
 #include <exception>
 #include <string>
+#include <map>
+#include <vector>
 
 using namespace std;
 
 #define  UDO_MAX_PAYLOAD_LEN  1024
 
+#define  UDO_BLOB_BATCH       64  // number of chunk transactions prepared at once for the blob transfers
+#define  UDO_PREFETCH_MAX     16  // maximal number of the read-ahead chunks (TUdoComm::prefetch_chunks)
+
+// client side read cache policies (TUdoComm::SetCachePolicy()), positive values are TTL in seconds
+#define  UDO_CACHE_NONE       (-1.0f)  // always read from the device
+#define  UDO_CACHE_FOREVER      0.0f   // read once (constants), until a write to the index or Open()
+
 enum TUdoCommProtocol
 {
 	UCP_NONE = 0,
@@ -38,12 +48,54 @@ public:
   }
 };
 
+struct TUdoTransaction;
+
+typedef struct TUdoCacheEntry
+{
+	nstime_t          expires;   // 0 = never
+	int               len;       // the original read result
+	vector<uint8_t>   data;      // the answer with the UdoRead() padding
+//
+} TUdoCacheEntry;
+
+typedef void (* PUdoCompletionFunc)(TUdoTransaction * atra);
+
+// master side transaction record, used for the pipelined (multiple requests in flight)
+// and for the asynchronous operations. The record is owned by the caller and must stay valid until completed
+// (with oncomplete: until the callback was called).
+typedef struct TUdoTransaction
+{
+	bool        iswrite;
+	uint16_t    index;
+	uint32_t    offset;
+	uint32_t    metadata;
+	uint32_t    rqlen;      // write: data length, read: maximal answer length
+	uint8_t *   dataptr;
+
+	int         anslen;     // read: received data length
+	uint16_t    result;     // 0 = ok, otherwise UDOERR_xxx
+	bool        completed;
+
+	PUdoCompletionFunc  oncomplete;  // optional, called from Poll() after the completion, might submit new transactions
+	void *              userdata;
+
+	// handler internals
+	uint32_t    rqid;
+	int         trynum;
+	nstime_t    sendtime;
+	TUdoTransaction *   next;
+//
+} TUdoTransaction;
+
 class TUdoCommHandler
 {
 public:
 	float             default_timeout = 1.0;
 	float             timeout = 1.0;
 	TUdoCommProtocol  protocol = UCP_NONE;
+	unsigned          max_inflight = 1;  // pipelining window: max. number of requests sent without answer
+	uint32_t          max_payload_ext = 0;  // large payload (object 0x0005) limit of the handler, 0 = not supported
+	uint32_t          max_payload = UDO_MAX_PAYLOAD_LEN;  // the negotiated payload size, set by TUdoComm::Open()
 
 	/* constructor */ TUdoCommHandler();
 	virtual           ~TUdoCommHandler();
@@ -56,13 +108,44 @@ public:
 
 	virtual int        UdoRead(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen);
 	virtual void       UdoWrite(uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen);
+
+	// executes a list of transactions, the results are stored into the records (no exceptions)
+	// when astop_on_short is set, no more requests are sent after an error or a short read (blob transfers)
+	virtual void       UdoTransactions(TUdoTransaction * atra, unsigned acount, bool astop_on_short);
+
+	// multi-read (object 0x0003): returns the raw answer, TUdoMultiReadAnsHead + data for every item
+	virtual int        UdoMultiRead(TUdoMultiReadItem * items, unsigned count, void * dataptr, uint32_t maxdatalen);
+
+public: // asynchronous interface, the completions are driven by Poll()
+	virtual void       SubmitTransaction(TUdoTransaction * atra);
+	virtual int        Poll(int atimeout_ms);  // returns the number of transactions completed since the last Poll()
+	virtual int        PollFd();               // for external event loops, -1 = not available
+	virtual bool       Busy();                 // there are submitted transactions not completed yet
+	void               WaitCompletion(TUdoTransaction * atra);  // without running the callbacks, those remain for the Poll()
+
+protected:
+	TUdoTransaction *  queue_first = nullptr;  // submitted transactions waiting to be started
+	TUdoTransaction *  queue_last = nullptr;
+	int                completion_count = 0;
+	TUdoTransaction *  done_first = nullptr;   // completed transactions waiting for their oncomplete call
+	TUdoTransaction *  done_last = nullptr;
+	uint32_t           exec_metadata = 0;      // metadata of the UdoRead() / UdoWrite() called by the ExecTransaction()
+
+	virtual void       Progress(int atimeout_ms);  // sending, receiving and timeouts without the callbacks, returns after a new completion
+	void               ExecTransaction(TUdoTransaction * atra);  // synchronous execution
+	void               ExecQueued(TUdoTransaction * atra);       // synchronous execution behind the submitted ones
+	void               QueueTransaction(TUdoTransaction * atra);
+	TUdoTransaction *  DequeueTransaction();
+	void               CompleteTransaction(TUdoTransaction * atra, uint16_t aresult);
+	int                DispatchCompletions();  // runs the oncomplete callbacks, returns and clears the completion_count
 };
 
 class TUdoComm
 {
 public:
 	TUdoCommHandler *  commh;  // defaults to commh_none
-	uint16_t           max_payload_size;
+	uint16_t           max_payload_size;  // might be bigger than UDO_MAX_PAYLOAD_LEN with large payload (0x0005)
+	bool               multiread_supported = true;  // cleared when the device does not know the object 0x0003
 
 	TUdoComm();
 	virtual            ~TUdoComm();
@@ -76,9 +159,31 @@ public:
 	int                UdoRead(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen);
 	void               UdoWrite(uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen);
 
+public: // asynchronous requests: non-blocking submission, the completions are processed by Poll()
+	void               SubmitRead(TUdoTransaction * atra, uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen,
+	                              PUdoCompletionFunc aoncomplete = nullptr, void * auserdata = nullptr);
+	void               SubmitWrite(TUdoTransaction * atra, uint16_t index, uint32_t offset, void * dataptr, uint32_t datalen,
+	                               PUdoCompletionFunc aoncomplete = nullptr, void * auserdata = nullptr);
+	int                Poll(int atimeout_ms);
+	int                PollFd();
+
 public: // utility functions
 	int                ReadBlob(uint16_t index, uint32_t offset, void *  dataptr, uint32_t maxdatalen);
-	void               WriteBlob(uint16_t index, uint32_t offset, void *  dataptr, uint32_t datalen);
+	// the chunks are written in batches (pipelined with max_inflight > 1), with averify the written range
+	// is checked with the blob checksum object (0x0006)
+	void               WriteBlob(uint16_t index, uint32_t offset, void *  dataptr, uint32_t datalen, bool averify = false);
+
+	// CRC32 (udo_calc_crc32()) of an object range calculated by the device (object 0x0006), the range
+	// is checked in UDO_BLOBCRC_MAX_LEN segments
+	uint32_t           BlobCrc32(uint16_t index, uint32_t offset, uint32_t length);
+
+	// reads a delta + varint packed scope capture (TScope::pfn_scope_data_packed) and unpacks it,
+	// returns the unpacked length. The packed stream is sequential, so it is read chunk by chunk.
+	int                ReadScopePacked(uint16_t index, void * dataptr, uint32_t maxdatalen);
+
+	// reads many (small) objects with as few requests as possible using the multi-read object,
+	// the results are stored into the records (index, offset, rqlen and dataptr must be set)
+	void               ReadMany(TUdoTransaction * atra, unsigned acount);
 
 	int32_t            ReadI32(uint16_t index, uint32_t offset);
 	int16_t            ReadI16(uint16_t index, uint32_t offset);
@@ -90,6 +195,54 @@ public: // utility functions
 	void               WriteU32(uint16_t index, uint32_t offset, uint32_t avalue);
 	void               WriteU16(uint16_t index, uint32_t offset, uint16_t avalue);
 	void               WriteU8(uint16_t index, uint32_t offset, uint8_t avalue);
+
+public: // client side read cache for the UdoRead() and the ReadXXX() functions, the blob reads are not cached
+	bool               cache_enabled = false;
+	bool               cache_learn = true;          // the policy of the unknown indexes is asked from the device (object 0x0004)
+	bool               objdesc_supported = true;    // cleared when the device does not know the object 0x0004
+	unsigned           cache_hits = 0;
+	unsigned           cache_misses = 0;
+
+	void               SetCachePolicy(uint16_t index, float attl);  // UDO_CACHE_NONE, UDO_CACHE_FOREVER or TTL in seconds
+	void               InvalidateCache(uint16_t index);             // drops the cached values of the index
+	void               ClearCache();                                // drops the cached values and the learned policies
+
+public: // read-ahead for the sequential ReadBlob() calls (like reading a log in small pieces)
+	// When two ReadBlob() calls follow each other on the same index, the next chunks are submitted as
+	// asynchronous reads and the further sequential calls are served from them. Writes to the index drop them.
+	// Not suitable for objects where the read has side effects.
+	unsigned           prefetch_chunks = 0;  // number of max_payload_size chunks to read ahead, 0 = disabled
+	unsigned           prefetch_hits = 0;    // ReadBlob() calls served from the read-ahead buffer
+
+	void               PrefetchDrop();       // forgets the read-ahead data, the pending reads complete in the background
+
+protected:
+	TUdoTransaction    blobtra[UDO_BLOB_BATCH];
+
+	TUdoTransaction    pftra[UDO_PREFETCH_MAX];  // ring of chunk reads
+	vector<uint8_t>    pf_buf;
+	uint16_t           pf_index = 0;
+	uint32_t           pf_offset = 0;     // device offset of the first chunk
+	uint32_t           pf_chunk = 0;      // chunk size
+	unsigned           pf_slots = 0;      // ring size
+	unsigned           pf_first = 0;      // ring position of the first chunk
+	unsigned           pf_count = 0;      // submitted chunks
+	uint16_t           seq_index = 0;     // the end of the previous ReadBlob() for the sequential detection
+	uint32_t           seq_offset = 0xFFFFFFFF;
+
+	int                ReadBlobDirect(uint16_t index, uint32_t offset, void *  dataptr, uint32_t maxdatalen);
+	bool               PrefetchRead(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen, int * rlen);
+	void               PrefetchStart(uint16_t index, uint32_t offset);
+	void               PrefetchFill();
+
+	map<uint16_t, float>           cache_policy;    // set by the application
+	map<uint16_t, float>           cache_learned;   // learned from the device
+	map<uint64_t, TUdoCacheEntry>  cache;           // key: index, length, offset
+
+	float              CachePolicy(uint16_t index);
+	float              LearnCachePolicy(uint16_t index);
+	bool               CacheGet(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen, int * rlen);
+	void               CachePut(uint16_t index, uint32_t offset, void * dataptr, uint32_t maxdatalen, int alen);
 };
 
 extern TUdoCommHandler  commh_none;
@@ -9,9 +9,21 @@
 #include "prgconfig.h"
 #include "udo_comm.h"
 #include "commh_udosl.h"
-#include "udo_ip_comm.h"
+#include "udoip_gateway.h"
 #include "wait_for_udo.h"
 
+#include <vector>
+
+class TUdoServerDevice  // one serial device with its own UDP port
+{
+public:
+	TCommHandlerUdoSl  commh;
+	TUdoComm           comm;
+	TUdoIpGateway      gateway;  // has its own worker thread
+};
+
+vector<TUdoServerDevice *>  devices;
+
 int main(int argc, char * const * argv)
 {
 	printf("UDOSERVER...\r\n");
@@ -29,35 +41,74 @@ int main(int argc, char * const * argv)
   	return 1;
   }
 
-  printf("Serial port: \"%s\"\n", prgconfig.udosl_devaddr.c_str());
-
-  udosl_commh.devstr = prgconfig.udosl_devaddr;
-  udocomm.SetHandler(&udosl_commh);
-
-  printf("Connecting to device ...\n");
-
-  udocomm.Open();
-
-  printf("  OK.\n");
+  if (prgconfig.udosl_devices.empty())  // single device configuration
+  {
+  	prgconfig.udosl_devices.push_back(prgconfig.udosl_devaddr);
+  	prgconfig.udosl_ports.push_back(0);
+  }
 
-  g_udoip_comm.Init();
-  printf("UDOIP Slave listening at port %u ...\n", g_udoip_comm.port);
+  if (prgconfig.udosl_devices.size() > UDOIP_WAIT_MAX_FDS)
+  {
+  	printf("Too many UDOSL_DEVICE entries: %u, maximum %u.\n", unsigned(prgconfig.udosl_devices.size()), UDOIP_WAIT_MAX_FDS);
+  	return 1;
+  }
 
-	prepare_udoip_wait(g_udoip_comm.fdsocket);
+  for (unsigned n = 0; n < prgconfig.udosl_devices.size(); ++n)
+  {
+  	TUdoServerDevice * dev = new TUdoServerDevice();
+  	dev->commh.devstr = prgconfig.udosl_devices[n];
+  	dev->comm.SetHandler(&dev->commh);
+  	dev->gateway.pcomm = &dev->comm;
+  	dev->gateway.ans_cache_count = prgconfig.udoip_anscache;
+  	dev->gateway.port = (prgconfig.udosl_ports[n] ? prgconfig.udosl_ports[n] : UDOIP_DEFAULT_PORT + n);
+
+  	printf("Serial port: \"%s\"\n", dev->commh.devstr.c_str());
+  	printf("Connecting to device ...\n");
+
+  	try
+  	{
+  		dev->comm.Open();
+  	}
+  	catch (EUdoAbort & e)
+  	{
+  		printf("  %s\n", e.what());
+  		return 1;
+  	}
+
+  	printf("  OK.\n");
+
+  	if (!dev->gateway.Start())  // the serial requests are executed in a separate thread
+  	{
+  		printf("Error starting the UDO-IP gateway at port %u.\n", dev->gateway.port);
+  		return 1;
+  	}
+  	printf("UDOIP Slave listening at port %u ...\n", dev->gateway.port);
+
+  	if (0 == n)
+  	{
+  		prepare_udoip_wait(dev->gateway.fdsocket);
+  	}
+  	else if (!add_udoip_wait(dev->gateway.fdsocket))
+  	{
+  		printf("Error adding the port %u to the UDP wait.\n", dev->gateway.port);
+  		return 1;
+  	}
+
+  	devices.push_back(dev);
+  }
 
   printf("Starting main cycle.\n");
 
   while (true)
   {
-		g_udoip_comm.Run();
-
-		// Do not use 100 % CPU time, especially on single core systems !
-		// Do not wait long because the scope data must be written right on time
-		#if 1
-  		wait_for_udoip_ms(1);  // Wait for UDO-IP requests for 1 ms
-		#else
-			usleep(1000);  // sleep for 1 ms
-		#endif
+  	for (TUdoServerDevice * dev : devices)
+  	{
+  		dev->gateway.Run();
+  	}
+
+		// the serial requests are executed in the gateway worker threads, so here
+		// only the UDP reception must be served, longer waits are allowed
+  	wait_for_udoip_ms(100);
   }
 
   printf("so far so good.\n");
@@ -1,12 +1,15 @@
 
 #include <prgconfig.h>
 #include "string.h"
+#include "stdlib.h"
 #include "general.h"
 
 TPrgConfig prgconfig;
 
 void TPrgConfig::Reset()
 {
+  udosl_devices.clear();
+  udosl_ports.clear();
 }
 
 bool TPrgConfig::ReadConfigFile(string fname)
@@ -91,6 +94,27 @@ bool TPrgConfig::ParseConfigLine(string idstr)
   	udosl_devaddr = ParseStringAssignment();
   	if (error)  return false;
   }
+  else if ("UDOIP_ANSCACHE" == idstr)
+  {
+  	udoip_anscache = ParseNumAssignment();
+  	if (error)  return false;
+  }
+  else if ("UDOSL_DEVICE" == idstr)
+  {
+  	string s = ParseStringAssignment();
+  	if (error)  return false;
+
+  	uint16_t port = 0;
+  	size_t i = s.rfind(':');
+  	if ((i != string::npos) && (i + 1 < s.size()) && (s.find_first_not_of("0123456789", i + 1) == string::npos))
+  	{
+  		port = atoi(s.substr(i + 1).c_str());
+  		s = s.substr(0, i);
+  	}
+
+  	udosl_devices.push_back(s);
+  	udosl_ports.push_back(port);
+  }
   else
   {
   	return false;
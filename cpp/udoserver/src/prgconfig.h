@@ -26,6 +26,13 @@ public:
 public:
   string    udosl_devaddr = "/dev/ttyACM0";
 
+  // multiple devices: UDOSL_DEVICE = "<device>:<udp port>"; lines, when the port is not given
+  // the devices get the ports 1221, 1222, ... in the order of the definitions
+  vector<string>    udosl_devices;
+  vector<uint16_t>  udosl_ports;
+
+  unsigned  udoip_anscache = 256;  // answer cache records per UDP port, for the repeated requests
+
 public:
   virtual   ~TPrgConfig() { }
   void      Reset();
@@ -0,0 +1,225 @@
+/*
+ *  file:     udoip_gateway.cpp
+ *  brief:    UDO-IP to UDO-SL gateway: UDP side decoupled from the serial device by a request queue
+ *  created:  2026-10-17
+ *  authors:  nvitya
+ *  license:  public domain
+*/
+
+#include "string.h"
+#include "udoip_gateway.h"
+#include "traces.h"
+#include "udoslaveapp.h"
+
+bool TUdoIpGateway::Start()
+{
+  rqbuf = &own_rqbuf[0];
+  rqbufsize = sizeof(own_rqbuf);
+
+  if (!ans_cache)
+  {
+    if (ans_cache_count < 4)  ans_cache_count = 4;
+    if (ans_cache_count > 0xFFFE)  ans_cache_count = 0xFFFE;
+
+    unsigned hashsize = 8;
+    while (hashsize < 2 * ans_cache_count)
+    {
+      hashsize <<= 1;
+    }
+
+    TUdoIpSlaveCacheRec * recs = new TUdoIpSlaveCacheRec[ans_cache_count];
+    uint8_t *  cachebuf = new uint8_t[ans_cache_count * UDOIP_MAX_RQ_SIZE];
+    uint16_t * hash = new uint16_t[hashsize];
+    if (!SetAnsCacheStorage(recs, ans_cache_count, cachebuf, hash, hashsize))
+    {
+      delete[] recs;
+      delete[] cachebuf;
+      delete[] hash;
+      return false;
+    }
+
+    own_cache_recs = recs;
+    own_cache_buf = cachebuf;
+    own_cache_hash = hash;
+  }
+
+  if (!Init())
+  {
+    return false;
+  }
+
+  free_first = nullptr;
+  for (unsigned n = 0; n < UDOGW_QUEUE_LEN; ++n)
+  {
+    rqpool[n].next = free_first;
+    free_first = &rqpool[n];
+  }
+  queue_first = nullptr;
+  queue_last = nullptr;
+  current = nullptr;
+
+  stopping = false;
+  worker = new std::thread(&TUdoIpGateway::WorkerLoop, this);
+  return true;
+}
+
+void TUdoIpGateway::Stop()
+{
+  if (worker)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    cv_queue.notify_all();
+    worker->join();
+    delete worker;
+    worker = nullptr;
+  }
+}
+
+void TUdoIpGateway::FreeAnsCache()
+{
+  delete[] own_cache_recs;
+  delete[] own_cache_buf;
+  delete[] own_cache_hash;
+  own_cache_recs = nullptr;
+  own_cache_buf = nullptr;
+  own_cache_hash = nullptr;
+}
+
+TUdoIpGateway::~TUdoIpGateway()
+{
+  Stop();
+  FreeAnsCache();
+}
+
+void TUdoIpGateway::ProcessUdpRequest(TUdoIpRequest * ucrq)
+{
+  TUdoIpRqHeader * prqh = (TUdoIpRqHeader *)ucrq->dataptr;
+
+  if (ucrq->datalen < sizeof(TUdoIpRqHeader))
+  {
+    return;  // invalid request
+  }
+
+  std::unique_lock<std::mutex> lock(mtx);
+
+  // repeated request with a cached answer ?
+  TUdoIpSlaveCacheRec * pansc = FindAnsCache(ucrq, prqh);
+  if (pansc)
+  {
+    ++repeated_count;
+    UdpRespondTo(ucrq->srcip, ucrq->srcport, pansc->dataptr, pansc->datalen);
+    return;
+  }
+
+  // repeated request which is not answered yet ? (the answer will be sent when it is ready)
+  if (IsPending(ucrq))
+  {
+    ++repeated_count;
+    return;
+  }
+
+  TUdoGwRequest * grq = free_first;
+  if (!grq)
+  {
+    ++dropped_count;  // the client will repeat it
+    return;
+  }
+  free_first = grq->next;
+
+  grq->iprq = *ucrq;
+  grq->iprq.dataptr = &grq->rqbuf[0];
+  memcpy(&grq->rqbuf[0], ucrq->dataptr, ucrq->datalen);
+  grq->next = nullptr;
+
+  if (queue_last)
+  {
+    queue_last->next = grq;
+  }
+  else
+  {
+    queue_first = grq;
+  }
+  queue_last = grq;
+
+  lock.unlock();
+  cv_queue.notify_one();
+}
+
+void TUdoIpGateway::AppReadWrite(TUdoRequest * udorq)  // called from the worker thread
+{
+  udo_forward_read_write(pcomm, udorq);
+}
+
+void TUdoIpGateway::AppMultiRead(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count)
+{
+  udo_forward_multi_read(pcomm, udorq, items, count);
+}
+
+bool TUdoIpGateway::SameRequest(TUdoGwRequest * grq, TUdoIpRequest * ucrq)
+{
+  return (grq->iprq.srcip == ucrq->srcip) && (grq->iprq.srcport == ucrq->srcport)
+         && (grq->iprq.datalen == ucrq->datalen)
+         && (0 == memcmp(&grq->rqbuf[0], ucrq->dataptr, sizeof(TUdoIpRqHeader)));
+}
+
+bool TUdoIpGateway::IsPending(TUdoIpRequest * ucrq)
+{
+  if (current && SameRequest(current, ucrq))
+  {
+    return true;
+  }
+
+  for (TUdoGwRequest * grq = queue_first; grq; grq = grq->next)
+  {
+    if (SameRequest(grq, ucrq))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void TUdoIpGateway::WorkerLoop()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+
+  while (true)
+  {
+    cv_queue.wait(lock, [this]{ return stopping || (queue_first != nullptr); });
+    if (stopping)
+    {
+      break;
+    }
+
+    current = queue_first;
+    queue_first = current->next;
+    if (!queue_first)  queue_last = nullptr;
+
+    lock.unlock();
+
+    // the (slow) serial transaction runs without the lock
+    current->anslen = ExecRequest(&wudorq, &current->iprq, &current->ansbuf[0]);
+
+    lock.lock();
+
+    // store the answer for the repeated requests
+    TUdoIpRqHeader * prqh = (TUdoIpRqHeader *)&current->rqbuf[0];
+    TUdoIpSlaveCacheRec * pansc = AllocateAnsCache(&current->iprq, prqh);
+    memcpy(pansc->dataptr, &current->ansbuf[0], current->anslen);
+    pansc->datalen = current->anslen;
+
+    int r = UdpRespondTo(current->iprq.srcip, current->iprq.srcport, &current->ansbuf[0], current->anslen);
+    if (r <= 0)
+    {
+      TRACE("UdoIpGateway: error sending back the answer: %i!\r\n", r);
+    }
+
+    current->next = free_first;
+    free_first = current;
+    current = nullptr;
+  }
+}
@@ -0,0 +1,83 @@
+/*
+ *  file:     udoip_gateway.h
+ *  brief:    UDO-IP to UDO-SL gateway: UDP side decoupled from the serial device by a request queue
+ *  created:  2026-10-17
+ *  authors:  nvitya
+ *  license:  public domain
+*/
+
+#ifndef UDOIP_GATEWAY_H_
+#define UDOIP_GATEWAY_H_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "udo_ip_comm.h"
+#include "udo_comm.h"
+
+#ifndef UDOGW_QUEUE_LEN
+  #define UDOGW_QUEUE_LEN  16  // maximal number of the queued (not yet answered) requests
+#endif
+
+typedef struct TUdoGwRequest
+{
+	TUdoIpRequest       iprq;       // iprq.dataptr points to the rqbuf
+	unsigned            anslen;     // answer length with header
+	TUdoGwRequest *     next;
+
+	uint8_t             rqbuf[UDOIP_MAX_RQ_SIZE];
+	uint8_t             ansbuf[UDOIP_MAX_RQ_SIZE];
+//
+} TUdoGwRequest;
+
+class TUdoIpGateway : public TUdoIpComm
+{
+private:
+	typedef TUdoIpComm super;
+
+public:
+	TUdoComm *          pcomm = &udocomm;    // the requests are forwarded here
+	unsigned            ans_cache_count = 256;  // answer cache records (~1 kByte each), allocated at Start()
+
+	uint32_t            dropped_count = 0;   // requests dropped because the queue was full
+	uint32_t            repeated_count = 0;  // repeated requests answered from the cache or already queued
+
+	virtual             ~TUdoIpGateway();
+
+	bool                Start();  // Init() + starts the serial worker thread
+	void                Stop();
+
+	virtual void        ProcessUdpRequest(TUdoIpRequest * ucrq);  // called from the UDP thread (Run())
+
+	virtual void        AppReadWrite(TUdoRequest * udorq);
+	virtual void        AppMultiRead(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count);
+
+protected:
+	std::mutex               mtx;  // protects the queue and the answer cache
+	std::condition_variable  cv_queue;
+	std::thread *            worker = nullptr;
+	bool                     stopping = false;
+
+	TUdoGwRequest       rqpool[UDOGW_QUEUE_LEN];
+	TUdoGwRequest *     free_first = nullptr;
+	TUdoGwRequest *     queue_first = nullptr;
+	TUdoGwRequest *     queue_last = nullptr;
+	TUdoGwRequest *     current = nullptr;   // under execution by the worker
+
+	TUdoRequest         wudorq;  // used by the worker
+
+	uint8_t             own_rqbuf[UDOIP_MAX_RQ_SIZE];  // every gateway instance has its own buffers
+
+	TUdoIpSlaveCacheRec *  own_cache_recs = nullptr;  // answer cache storage allocated by the Start()
+	uint8_t *           own_cache_buf = nullptr;
+	uint16_t *          own_cache_hash = nullptr;
+
+	void                FreeAnsCache();
+
+	bool                SameRequest(TUdoGwRequest * grq, TUdoIpRequest * ucrq);
+	bool                IsPending(TUdoIpRequest * ucrq);
+	void                WorkerLoop();
+};
+
+#endif /* UDOIP_GATEWAY_H_ */
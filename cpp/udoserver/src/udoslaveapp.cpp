@@ -5,8 +5,8 @@
  *  authors:  nvitya
 */
 
+#include "string.h"
 #include <udoslaveapp.h>
-#include "udo_comm.h"
 
 // the udoslave_app_read_write() is called from the communication system (Serial or IP) to
 // handle the actual UDO requests
@@ -21,7 +21,19 @@ bool udoslave_app_read_write(TUdoRequest * udorq)
 
 #endif
 
-  if (!udocomm.Opened())
+  return udo_forward_read_write(&udocomm, udorq);
+}
+
+// multi-read lists coming inline from the UDO-IP clients are forwarded at once
+
+bool udoslave_app_multi_read(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count)
+{
+  return udo_forward_multi_read(&udocomm, udorq, items, count);
+}
+
+bool udo_forward_read_write(TUdoComm * acomm, TUdoRequest * udorq)
+{
+  if (!acomm->Opened())
   {
   	return udoslave_handle_base_objects(udorq);
   }
@@ -29,14 +41,37 @@ bool udoslave_app_read_write(TUdoRequest * udorq)
   // forward all requests
   try
   {
+  	if (udorq->metadata)
+  	{
+  		// the metadata (like the blob checksum range) can be forwarded only with a transaction record
+  		TUdoTransaction tra;
+  		tra.iswrite  = udorq->iswrite;
+  		tra.index    = udorq->index;
+  		tra.offset   = udorq->offset;
+  		tra.metadata = udorq->metadata;
+  		tra.rqlen    = (udorq->iswrite ? udorq->rqlen : udorq->maxanslen);
+  		tra.dataptr  = udorq->dataptr;
+  		tra.oncomplete = nullptr;
+  		acomm->commh->UdoTransactions(&tra, 1, false);
+  		if (tra.result)
+  		{
+  			return udo_response_error(udorq, tra.result);
+  		}
+  		if (!udorq->iswrite)
+  		{
+  			udorq->anslen = tra.anslen;
+  		}
+  		return udo_response_ok(udorq);
+  	}
+
   	if (udorq->iswrite)
   	{
-  		udocomm.UdoWrite(udorq->index,  udorq->offset, udorq->dataptr, udorq->rqlen);
+  		acomm->UdoWrite(udorq->index,  udorq->offset, udorq->dataptr, udorq->rqlen);
   		return udo_response_ok(udorq);
   	}
   	else
   	{
-  		int r = udocomm.UdoRead(udorq->index,  udorq->offset, udorq->dataptr, udorq->maxanslen);
+  		int r = acomm->UdoRead(udorq->index,  udorq->offset, udorq->dataptr, udorq->maxanslen);
   		udorq->anslen = r;
   		return udo_response_ok(udorq);
   	}
@@ -46,3 +81,24 @@ bool udoslave_app_read_write(TUdoRequest * udorq)
   	return udo_response_error(udorq, e.ecode);
 	}
 }
+
+bool udo_forward_multi_read(TUdoComm * acomm, TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count)
+{
+  if (!acomm->Opened())
+  {
+  	return udoslave_multi_read(udorq, items, count);
+  }
+
+  try
+  {
+  	TUdoMultiReadItem  list[UDO_MULTIREAD_MAX_ITEMS];
+  	memcpy(&list[0], items, count * sizeof(TUdoMultiReadItem));  // the list might be unaligned
+  	int r = acomm->commh->UdoMultiRead(&list[0], count, udorq->dataptr, udorq->maxanslen);
+  	udorq->anslen = r;
+  	return udo_response_ok(udorq);
+  }
+  catch (EUdoAbort &e)
+	{
+  	return udo_response_error(udorq, e.ecode);
+	}
+}
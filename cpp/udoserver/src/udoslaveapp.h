@@ -10,5 +10,10 @@
 #define UDOSLAVEAPP_H_
 
 #include "udoslave.h"
+#include "udo_comm.h"
+
+// forwarding the requests to a (serial) UDO device, base objects only when it is not opened
+bool udo_forward_read_write(TUdoComm * acomm, TUdoRequest * udorq);
+bool udo_forward_multi_read(TUdoComm * acomm, TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count);
 
 #endif /* UDOSLAVEAPP_H_ */
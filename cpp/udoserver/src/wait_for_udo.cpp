@@ -22,12 +22,23 @@ void prepare_udoip_wait(int afd)
   //udoip_poll.revents = 0;
 }
 
+bool add_udoip_wait(int afd)
+{
+  if (udoip_poll.fd_count >= FD_SETSIZE)
+  {
+    return false;
+  }
+  FD_SET(afd, &udoip_poll);
+  return true;
+}
+
 bool wait_for_udoip_ms(int atimeout_ms)
 {
   TIMEVAL tv;
-  tv.tv_sec = 0;
-  tv.tv_usec = atimeout_ms * 1000;
-  int r = select(0, &udoip_poll, nullptr, nullptr, &tv);
+  tv.tv_sec = atimeout_ms / 1000;
+  tv.tv_usec = (atimeout_ms % 1000) * 1000;
+  fd_set rdset = udoip_poll;  // select() modifies the set
+  int r = select(0, &rdset, nullptr, nullptr, &tv);
   if (r > 0)
   {
     return true;
@@ -42,18 +53,33 @@ bool wait_for_udoip_ms(int atimeout_ms)
 #else
 
 #include "poll.h"
-struct pollfd  udoip_poll;
+struct pollfd  udoip_poll[UDOIP_WAIT_MAX_FDS];
+unsigned       udoip_poll_count = 0;
 
 void prepare_udoip_wait(int afd)
 {
-  udoip_poll.fd = afd;
-  udoip_poll.events = POLLIN;
-  udoip_poll.revents = 0;
+  udoip_poll_count = 0;
+  add_udoip_wait(afd);
+}
+
+bool add_udoip_wait(int afd)
+{
+  if (udoip_poll_count >= UDOIP_WAIT_MAX_FDS)
+  {
+    return false;
+  }
+
+  struct pollfd * pfd = &udoip_poll[udoip_poll_count];
+  pfd->fd = afd;
+  pfd->events = POLLIN;
+  pfd->revents = 0;
+  ++udoip_poll_count;
+  return true;
 }
 
 bool wait_for_udoip_ms(int atimeout_ms)
 {
-  int r = poll(&udoip_poll, 1, atimeout_ms);
+  int r = poll(&udoip_poll[0], udoip_poll_count, atimeout_ms);
   if (r > 0)
   {
     return true;
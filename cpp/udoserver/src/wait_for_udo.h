@@ -8,7 +8,10 @@
 #ifndef DLCORE_WAIT_FOR_UDO_H_
 #define DLCORE_WAIT_FOR_UDO_H_
 
+#define UDOIP_WAIT_MAX_FDS  16
+
 void prepare_udoip_wait(int afd);
+bool add_udoip_wait(int afd);  // wait for more sockets (multiple UDO-IP ports), false = too many sockets
 bool wait_for_udoip_ms(int atimeout_ms);
 
 #endif /* DLCORE_WAIT_FOR_UDO_H_ */
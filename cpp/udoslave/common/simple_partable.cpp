@@ -30,18 +30,60 @@
 
 //-----------------------------------------------------------------------------
 
+TParamRangeIndex  param_range_index;  // zero initialized: not built
+
+bool prtable_index_build(TParamRangeIndex * pridx, TParamRangeDef * prtab)
+{
+	pridx->prtab = nullptr;
+
+	TParamRangeDef * prd = prtab;
+	for (unsigned page = 0; page <= 256; ++page)
+	{
+		// skip the ranges ending before this page
+		while (prd->lastindex && (prd->lastindex < (page << 8)))
+		{
+			++prd;
+		}
+
+		unsigned rangenum = prd - prtab;  // might be the closing record
+		if (rangenum > 255)
+		{
+			return false;  // too many ranges, the linear search remains
+		}
+		pridx->page_first[page] = rangenum;
+	}
+
+	pridx->prtab = prtab;
+	return true;
+}
+
+bool param_range_index_init()
+{
+	return prtable_index_build(&param_range_index, (TParamRangeDef *)param_range_table);
+}
+
+static inline TParamRangeDef * param_range_first(uint16_t aindex)
+{
+	if (param_range_index.prtab)
+	{
+		return prtable_index_lookup(&param_range_index, aindex);
+	}
+
+	return (TParamRangeDef *)param_range_table;
+}
+
 // default WEAK implementations:
 
 __attribute__((weak))
 TParameterDef * pdef_get(uint16_t aindex)
 {
-	return prtable_pdef_get((TParamRangeDef *)param_range_table, aindex);
+	return prtable_pdef_get(param_range_first(aindex), aindex);
 }
 
 __attribute__((weak))
 bool param_read_write(TUdoRequest * udorq)
 {
-	return prtable_read_write((TParamRangeDef *)param_range_table, udorq);
+	return prtable_read_write(param_range_first(udorq->index), udorq);
 }
 
 //-----------------------------------------------------------------------------
@@ -128,6 +170,34 @@ TParameterDef * prtable_pdef_get(TParamRangeDef * prtab, uint16_t aindex)
 	return nullptr;
 }
 
+bool param_object_desc(uint16_t aindex, uint32_t * rdesc)
+{
+	TParameterDef * pdef = pdef_get(aindex);
+	if (!pdef)
+	{
+		return false;
+	}
+
+	uint32_t rwflags = (pdef->flags & PARF_RW_MASK);
+	if (PARF_ROCONST == rwflags)
+	{
+		*rdesc = (UDO_OBJDESC_READONLY | UDO_OBJDESC_CONST);
+	}
+	else if (PARF_READONLY == rwflags)
+	{
+		*rdesc = UDO_OBJDESC_READONLY;
+	}
+	else if (PARF_WRITEONLY == rwflags)
+	{
+		*rdesc = UDO_OBJDESC_WRITEONLY;
+	}
+	else
+	{
+		*rdesc = 0;
+	}
+	return true;
+}
+
 __attribute__((weak))
 int pdef_varsize(TParameterDef * pdef)
 {
@@ -46,11 +46,53 @@ struct TParamRangeDef
 //
 };
 
+// Optional lookup index for the range table: for every 256 index page (high byte of the index)
+// it stores the first range which might contain an index from the page, the ranges of the page
+// are binary searched then. The range table must be sorted by the index.
+
+struct TParamRangeIndex
+{
+	TParamRangeDef *       prtab;              // nullptr = not built
+	uint8_t                page_first[257];    // the last one points to the closing record
+//
+};
+
+bool prtable_index_build(TParamRangeIndex * pridx, TParamRangeDef * prtab);
+
+// returns the range containing aindex, or the range after it (the table scan stops there at once)
+inline TParamRangeDef * prtable_index_lookup(TParamRangeIndex * pridx, uint16_t aindex)
+{
+	unsigned lo = pridx->page_first[aindex >> 8];
+	unsigned hi = pridx->page_first[(aindex >> 8) + 1];  // might contain aindex too (crossing the page end)
+	while (lo < hi)
+	{
+		unsigned mid = ((lo + hi) >> 1);
+		if (pridx->prtab[mid].lastindex < aindex)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return pridx->prtab + lo;
+}
+
+// builds the index for the param_range_table, the default pdef_get() and param_read_write() use it afterwards.
+// Not called automatically: the firmware must call it once, after its param_range_table is final.
+bool param_range_index_init();
+
+extern TParamRangeIndex  param_range_index;
+
 TParameterDef * prtable_pdef_get(TParamRangeDef * prtab, uint16_t aindex);
 TParameterDef * pdef_get(uint16_t aindex); // WEAK implementation by default
 
 int pdef_varsize(TParameterDef * pdef);
 
+// UDO_OBJDESC_ flags of a table entry for the object 0x0004, returns false when the index has no pdef
+bool param_object_desc(uint16_t aindex, uint32_t * rdesc);
+
 bool pdef_empty(TParameterDef * pdef);
 
 bool param_handle_pdef(TUdoRequest * udorq, TParameterDef * pdef);
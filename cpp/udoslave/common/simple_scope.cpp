@@ -59,7 +59,7 @@ void TScope::Run() // Called from the idle cycle
 
 	// check for scope start
 
-	if ((state & 0x07) == 0) // idle or ready
+	if ((SCOPE_LOAD_ACQUIRE(state) & 0x07) == 0) // idle or ready, RunIrqTask() does not touch the sampling data
 	{
 		if (cmd & 1)
 		{
@@ -67,7 +67,15 @@ void TScope::Run() // Called from the idle cycle
 			PrepareSampling();
 			if (channel_count > 0)
 			{
-				state = SCOPE_STATE_PREFILL;
+				// the release publishes the sampling setup to RunIrqTask()
+				if (SCOPE_CMD_STREAM == cmd)
+				{
+					SCOPE_STORE_RELEASE(state, SCOPE_STATE_STREAMING);
+				}
+				else
+				{
+					SCOPE_STORE_RELEASE(state, SCOPE_STATE_PREFILL);
+				}
 			}
 		}
 	}
@@ -117,6 +125,27 @@ bool TScope::pfn_scope_cmd(TUdoRequest * udorq, TParameterDef * pdef, void * var
 	return true;
 }
 
+bool TScope::pfn_scope_stream_ack(TUdoRequest * udorq, TParameterDef * pdef, void * varptr)
+{
+	uint32_t ridx = stream_rd_idx;  // owned by the readout
+	bool     ready = (SCOPE_LOAD_ACQUIRE(stream_wr_idx) != ridx);
+	uint32_t seq = (ready ? stream_seg_seq[ridx % SCOPE_STREAM_SEGMENTS] : stream_rd_seq);
+
+	if (!udorq->iswrite)
+	{
+		return udo_ro_uint(udorq, seq, 4);
+	}
+
+	// release the segment to RunIrqTask(), other sequence numbers are ignored
+	if (ready && (uint32_t(udorq_uintvalue(udorq)) == seq))
+	{
+		stream_rd_seq = seq;
+		SCOPE_STORE_RELEASE(stream_rd_idx, ridx + 1);
+	}
+
+	return udo_response_ok(udorq);
+}
+
 bool TScope::pfn_scope_data(TUdoRequest * udorq, TParameterDef * pdef, void * varptr)
 {
 	if (udorq->iswrite)
@@ -124,6 +153,31 @@ bool TScope::pfn_scope_data(TUdoRequest * udorq, TParameterDef * pdef, void * va
 		return udo_response_error(udorq, UDOERR_READ_ONLY);
 	}
 
+	uint8_t st = SCOPE_LOAD_ACQUIRE(state);  // the sample data written before the state change is visible
+
+	if (SCOPE_STATE_STREAMING == st)
+	{
+		// the oldest ready segment, without wrap-around
+		uint32_t ridx = stream_rd_idx;
+		unsigned readylen = ((SCOPE_LOAD_ACQUIRE(stream_wr_idx) != ridx) ? stream_seg_bytes : 0);
+		if (0xFFFFFFFF == udorq->offset)
+		{
+			return udo_ro_int(udorq, readylen, 4);
+		}
+
+		if (readylen <= udorq->offset)
+		{
+			udorq->anslen = 0;
+			return true;
+		}
+
+		unsigned len = readylen - udorq->offset;
+		if (len > udorq->maxanslen)  len = udorq->maxanslen;
+		udorq->dataptr = StreamSegmentPtr(ridx) + udorq->offset;  // send directly from the scope buffer
+		udorq->anslen = len;
+		return udo_response_ok(udorq);
+	}
+
   unsigned fullsize = sample_count * sample_width;
   if (0xFFFFFFFF == udorq->offset)  // special offset, return the data length
   {
@@ -149,17 +203,161 @@ bool TScope::pfn_scope_data(TUdoRequest * udorq, TParameterDef * pdef, void * va
   	psrc = pbuffer + (psrc - buf_end_ptr);
   }
 
-  uint8_t * pdst = udorq->dataptr;
-  while (remaining > 0)
+  unsigned firstlen = buf_end_ptr - psrc;  // until the end of the ring
+  if (remaining <= firstlen)
   {
-  	*pdst++ = *psrc++;
-  	if (psrc >= buf_end_ptr)  psrc = pbuffer;
-  	--remaining;
+  	udorq->dataptr = psrc;  // contiguous: send directly from the scope buffer
+  }
+  else
+  {
+  	memcpy(udorq->dataptr, psrc, firstlen);
+  	memcpy(udorq->dataptr + firstlen, pbuffer, remaining - firstlen);
   }
 
   return udo_response_ok(udorq);
 }
 
+bool TScope::pfn_scope_data_packed(TUdoRequest * udorq, TParameterDef * pdef, void * varptr)
+{
+	if (udorq->iswrite)
+	{
+		return udo_response_error(udorq, UDOERR_READ_ONLY);
+	}
+
+	if (SCOPE_STATE_STREAMING == SCOPE_LOAD_ACQUIRE(state))
+	{
+		return udo_response_error(udorq, UDOERR_WRONG_ACCESS);  // only for the captures
+	}
+
+	if ((0 == udorq->offset) || (udorq->offset != pk_offset))
+	{
+		// new readout or a repeated chunk: encode again from the beginning (without storing) up to the offset
+		PackStart();
+		while (pk_offset < udorq->offset)
+		{
+			if (0 == PackChunk(nullptr, udorq->offset - pk_offset))
+			{
+				break;
+			}
+		}
+
+		if (pk_offset != udorq->offset)
+		{
+			return udo_response_error(udorq, UDOERR_WRONG_OFFSET);
+		}
+	}
+
+	udorq->anslen = PackChunk(udorq->dataptr, udorq->maxanslen);  // 0 = end of the data
+	return udo_response_ok(udorq);
+}
+
+static unsigned scope_put_varint(uint8_t * dst, uint32_t avalue)  // returns the encoded length (max 5)
+{
+	unsigned len = 0;
+	while (avalue >= 0x80)
+	{
+		dst[len++] = uint8_t(avalue | 0x80);
+		avalue >>= 7;
+	}
+	dst[len++] = uint8_t(avalue);
+	return len;
+}
+
+void TScope::PackStart()
+{
+	unsigned ch;
+	unsigned rep;
+
+	pk_field_count = 0;
+	for (ch = 0; ch < channel_count; ++ch)
+	{
+		unsigned bytelen = channels[ch].bytelen;
+		for (rep = 0; rep < (SCOPE_SMP_MODE_MINMAX == active_smp_mode ? 2u : 1u); ++rep)
+		{
+			if (bytelen > 4)
+			{
+				pk_widths[pk_field_count++] = 4;  // 8 byte values as two 32 bit fields
+				pk_widths[pk_field_count++] = 4;
+			}
+			else
+			{
+				pk_widths[pk_field_count++] = bytelen;
+			}
+		}
+	}
+
+	pk_hdr[0] = SCOPE_PACK_VERSION;
+	pk_hdr[1] = pk_field_count;
+	memcpy(&pk_hdr[2], &pk_widths[0], pk_field_count);
+	pk_hdr_len = 2 + pk_field_count;
+	pk_hdr_len += scope_put_varint(&pk_hdr[pk_hdr_len], (pk_field_count ? sample_count * sample_width : 0));
+	pk_hdr_pos = 0;
+
+	memset(&pk_prev[0], 0, sizeof(pk_prev));
+	pk_field = 0;
+	pk_field_pos = 0;
+	pk_smp = 0;
+	pk_smp_ptr = next_smp_ptr;  // the oldest sample
+	pk_offset = 0;
+}
+
+unsigned TScope::PackChunk(uint8_t * dst, unsigned maxlen)
+{
+	unsigned len = 0;
+
+	// the rest of the header
+	while ((pk_hdr_pos < pk_hdr_len) && (len < maxlen))
+	{
+		if (dst)  dst[len] = pk_hdr[pk_hdr_pos];
+		++len;
+		++pk_hdr_pos;
+	}
+
+	if (pk_hdr_pos < pk_hdr_len)
+	{
+		pk_offset += len;
+		return len;
+	}
+
+	// the samples, only whole varints
+	uint8_t  vbuf[5];
+	while ((pk_smp < sample_count) && pk_field_count)
+	{
+		unsigned width = pk_widths[pk_field];
+		unsigned shift = 32 - 8 * width;
+		uint32_t v = 0;
+		memcpy(&v, pk_smp_ptr + pk_field_pos, width);  // little endian
+
+		int32_t  diff = int32_t((v - pk_prev[pk_field]) << shift) >> shift;
+		unsigned vlen = scope_put_varint(&vbuf[0], (uint32_t(diff) << 1) ^ uint32_t(diff >> 31));
+		if (len + vlen > maxlen)
+		{
+			break;
+		}
+
+		if (dst)  memcpy(dst + len, &vbuf[0], vlen);
+		len += vlen;
+
+		pk_prev[pk_field] = v;
+		pk_field_pos += width;
+		++pk_field;
+		if (pk_field >= pk_field_count)
+		{
+			pk_field = 0;
+			pk_field_pos = 0;
+			++pk_smp;
+			pk_smp_ptr += sample_width;
+			if (pk_smp_ptr >= buf_end_ptr)
+			{
+				pk_smp_ptr = pbuffer;
+			}
+		}
+	}
+
+	pk_offset += len;
+	return len;
+}
+
 bool TScope::SetChannelDef(unsigned achnum, unsigned adef)
 {
 	TScopeChannelData * pch = &channels[achnum];
@@ -222,6 +420,8 @@ void TScope::PrepareSampling()
 
 			sample_width += pch->bytelen;
 			++channel_count;
+
+			pch->valtype = (pch->pdef->flags & PARF_TYPE_MASK);
 		}
 		else // stop at the first empty / invalid entry
 		{
@@ -240,12 +440,41 @@ void TScope::PrepareSampling()
 		trigger_channel = 0;
 	}
 
+	active_smp_mode = smp_mode;
+	if (SCOPE_SMP_MODE_MINMAX == active_smp_mode)
+	{
+		sample_width *= 2;  // min + max
+	}
+	else if (SCOPE_SMP_MODE_AVERAGE != active_smp_mode)
+	{
+		active_smp_mode = SCOPE_SMP_MODE_SAMPLE;
+	}
+	dec_count = 0;
+
 	sample_count = buffer_size / sample_width;
 	if ((max_samples > 0) && (max_samples < sample_count))
 	{
 		sample_count = max_samples;
 	}
 
+	if (SCOPE_CMD_STREAM == cmd)
+	{
+		sample_count -= (sample_count % SCOPE_STREAM_SEGMENTS);  // equal segments
+		if (0 == sample_count)
+		{
+			channel_count = 0;  // the buffer is too small
+			return;
+		}
+		stream_seg_bytes = sample_width * (sample_count / SCOPE_STREAM_SEGMENTS);
+		stream_seg_end = pbuffer + stream_seg_bytes;
+		stream_wr_idx = 0;
+		stream_rd_idx = 0;
+		stream_rd_seq = 0;
+		stream_counter = 0;
+		stream_seq = 0;
+		stream_overflow = 0;
+	}
+
 	presmp_count  = (sample_count * pretrigger_percent) / 100;
 	postsmp_count = sample_count - presmp_count;
 
@@ -288,53 +517,83 @@ void TScope::PrepareSampling()
 
 void TScope::RunIrqTask()
 {
-	if (   (SCOPE_STATE_WAITTRIG == state) || (SCOPE_STATE_PREFILL == state)
-			|| (SCOPE_STATE_POSTFILL == state) || (SCOPE_STATE_PERMREC == state) )
+	uint8_t st = SCOPE_LOAD_ACQUIRE(state);  // pairs with the release in Run()
+
+	if (   (SCOPE_STATE_WAITTRIG == st) || (SCOPE_STATE_PREFILL == st)
+			|| (SCOPE_STATE_POSTFILL == st) || (SCOPE_STATE_PERMREC == st)
+			|| (SCOPE_STATE_STREAMING == st) )
 	{
 		// run the sampling
 
 		unsigned n;
+		uint8_t  acmd = __atomic_load_n(&cmd, __ATOMIC_RELAXED);  // written by the UDO handler
 
 		++smp_cycle_counter;
 
-		if (SCOPE_CMD_STOP == cmd)
+		if (SCOPE_SMP_MODE_SAMPLE != active_smp_mode)
+		{
+			AccumulateChannels();  // min / max or sum over the smp_cycles window
+		}
+
+		if (SCOPE_CMD_STOP == acmd)
 		{
 			// stop the sampling
-			state = SCOPE_STATE_IDLE;
+			SCOPE_STORE_RELEASE(state, SCOPE_STATE_IDLE);
 		}
 		else if (smp_cycle_counter >= smp_cycles)
 		{
 			smp_cycle_counter = 0;
 
-      // optimized sampling cycle
-			TScopeChannelData * pch = &channels[0];
-			TScopeChannelData * pch_end = pch + channel_count;
-      while (pch < pch_end)
-      {
-        #if MCU_NO_UNALIGNED
-          for (n = 0; n < pch->bytelen; ++n)
-          {
-            *next_smp_ptr++ = pch->varptr[n];
-          }
-        #else
-          if (2 == pch->bytelen) // most probable case
-          {
-            *(uint16_t *)next_smp_ptr = *(uint16_t *)pch->varptr;
-            next_smp_ptr += 2;
-          }
-          else if (4 == pch->bytelen)
-          {
-            *(uint32_t *)next_smp_ptr = *(uint32_t *)pch->varptr;
-            next_smp_ptr += 4;
-          }
-          else
-          {
-            *next_smp_ptr = *pch->varptr;
-            next_smp_ptr += 1;
-          }
-        #endif
-        ++pch;
-      }
+			if (SCOPE_SMP_MODE_SAMPLE != active_smp_mode)
+			{
+				StoreDecimated();
+			}
+			else
+			{
+        // optimized sampling cycle
+				TScopeChannelData * pch = &channels[0];
+				TScopeChannelData * pch_end = pch + channel_count;
+        while (pch < pch_end)
+        {
+          #if MCU_NO_UNALIGNED
+            for (n = 0; n < pch->bytelen; ++n)
+            {
+              *next_smp_ptr++ = pch->varptr[n];
+            }
+          #else
+            if (2 == pch->bytelen) // most probable case
+            {
+              *(uint16_t *)next_smp_ptr = *(uint16_t *)pch->varptr;
+              next_smp_ptr += 2;
+            }
+            else if (4 == pch->bytelen)
+            {
+              *(uint32_t *)next_smp_ptr = *(uint32_t *)pch->varptr;
+              next_smp_ptr += 4;
+            }
+            else if (1 == pch->bytelen)
+            {
+              *next_smp_ptr = *pch->varptr;
+              next_smp_ptr += 1;
+            }
+            else
+            {
+              memcpy(next_smp_ptr, pch->varptr, pch->bytelen);
+              next_smp_ptr += pch->bytelen;
+            }
+          #endif
+          ++pch;
+        }
+			}
+
+			if (SCOPE_STATE_STREAMING == st)
+			{
+				if (next_smp_ptr >= stream_seg_end)
+				{
+					StreamSegmentDone();
+				}
+				return;  // no trigger in streaming mode
+			}
 
 			if (next_smp_ptr >= buf_end_ptr)
 			{
@@ -351,27 +610,27 @@ void TScope::RunIrqTask()
 			cur_tr_value = (cur_tr_value & tr_value_mask) + tr_value_add;  // prepare value for 32 bit unsigned comparison
 
 			// post sample state handling
-			switch (state)
+			switch (st)
 			{
 			case SCOPE_STATE_PREFILL:  // the sampling starts here
 				++cur_smp_index;
 				if (cur_smp_index >= presmp_count)
 				{
-					if (SCOPE_CMD_PERMREC == cmd)
+					if (SCOPE_CMD_PERMREC == acmd)
 					{
-						state = SCOPE_STATE_PERMREC;
+						SCOPE_STORE_RELEASE(state, SCOPE_STATE_PERMREC);
 					}
 					else
 					{
-						state = SCOPE_STATE_WAITTRIG;
+						SCOPE_STORE_RELEASE(state, SCOPE_STATE_WAITTRIG);
 					}
 				}
 				break;
 
 			case SCOPE_STATE_PERMREC:  // waiting for trigger arming
-				if ((SCOPE_CMD_FORCETRIG == cmd) || (SCOPE_CMD_START == cmd))
+				if ((SCOPE_CMD_FORCETRIG == acmd) || (SCOPE_CMD_START == acmd))
 				{
-					state = SCOPE_STATE_WAITTRIG;
+					SCOPE_STORE_RELEASE(state, SCOPE_STATE_WAITTRIG);
 				}
 				break;
 
@@ -379,7 +638,7 @@ void TScope::RunIrqTask()
 			{
 				bool triggered = false;
 
-				if ((SCOPE_CMD_FORCETRIG == cmd) || (0 == trigger_slope))
+				if ((SCOPE_CMD_FORCETRIG == acmd) || (0 == trigger_slope))
 				{
 					triggered = true;
 				}
@@ -417,7 +676,7 @@ void TScope::RunIrqTask()
 				if (triggered)
 				{
 					trigger_index = cur_smp_index;
-					state = SCOPE_STATE_POSTFILL;
+					SCOPE_STORE_RELEASE(state, SCOPE_STATE_POSTFILL);
 				}
 
 				break;
@@ -427,7 +686,7 @@ void TScope::RunIrqTask()
 				++cur_smp_index;
 				if (cur_smp_index >= sample_count)
 				{
-					state = SCOPE_STATE_DATAREADY;
+					SCOPE_STORE_RELEASE(state, SCOPE_STATE_DATAREADY);  // publishes the sample buffer to the readout
 				}
 				break;
 			}
@@ -437,3 +696,156 @@ void TScope::RunIrqTask()
 	}
 }
 
+void TScope::StreamSegmentDone()  // called from RunIrqTask()
+{
+	uint32_t widx = stream_wr_idx;  // owned by RunIrqTask()
+
+	++stream_counter;
+	if (widx + 1 - SCOPE_LOAD_ACQUIRE(stream_rd_idx) >= SCOPE_STREAM_SEGMENTS)
+	{
+		// the next segment is still not released by the readout, drop this one and fill it again
+		++stream_overflow;
+	}
+	else
+	{
+		// publish this segment and continue with the next one
+		stream_seg_seq[widx % SCOPE_STREAM_SEGMENTS] = stream_counter;
+		stream_seq = stream_counter;
+		SCOPE_STORE_RELEASE(stream_wr_idx, widx + 1);  // the sample data and the sequence number must be written before
+		++widx;
+	}
+
+	next_smp_ptr = StreamSegmentPtr(widx);
+	stream_seg_end = next_smp_ptr + stream_seg_bytes;
+}
+
+static inline TScopeValue scope_channel_value(TScopeChannelData * pch)  // sign or zero extended to 32 bit
+{
+	TScopeValue r;
+	if (4 == pch->bytelen)
+	{
+		memcpy(&r.u, pch->varptr, 4);
+	}
+	else if (2 == pch->bytelen)
+	{
+		uint16_t v16;
+		memcpy(&v16, pch->varptr, 2);
+		r.u = ((PARF_TYPE_INT == pch->valtype) ? uint32_t(int16_t(v16)) : v16);
+	}
+	else
+	{
+		uint8_t v8 = *pch->varptr;
+		r.u = ((PARF_TYPE_INT == pch->valtype) ? uint32_t(int8_t(v8)) : v8);
+	}
+	return r;
+}
+
+void TScope::AccumulateChannels()  // called from RunIrqTask() in every cycle
+{
+	TScopeChannelData * pch = &channels[0];
+	TScopeChannelData * pch_end = pch + channel_count;
+	while (pch < pch_end)
+	{
+		if (pch->bytelen <= 4)
+		{
+			TScopeValue v = scope_channel_value(pch);
+			if (PARF_TYPE_FLOAT == pch->valtype)
+			{
+				if (0 == dec_count)
+				{
+					pch->vmin.f = v.f;
+					pch->vmax.f = v.f;
+					pch->fsum = v.f;
+				}
+				else
+				{
+					if (v.f < pch->vmin.f)  pch->vmin.f = v.f;
+					if (v.f > pch->vmax.f)  pch->vmax.f = v.f;
+					pch->fsum += v.f;
+				}
+			}
+			else if (PARF_TYPE_INT == pch->valtype)
+			{
+				if (0 == dec_count)
+				{
+					pch->vmin.i = v.i;
+					pch->vmax.i = v.i;
+					pch->isum = v.i;
+				}
+				else
+				{
+					if (v.i < pch->vmin.i)  pch->vmin.i = v.i;
+					if (v.i > pch->vmax.i)  pch->vmax.i = v.i;
+					pch->isum += v.i;
+				}
+			}
+			else
+			{
+				if (0 == dec_count)
+				{
+					pch->vmin.u = v.u;
+					pch->vmax.u = v.u;
+					pch->isum = v.u;
+				}
+				else
+				{
+					if (v.u < pch->vmin.u)  pch->vmin.u = v.u;
+					if (v.u > pch->vmax.u)  pch->vmax.u = v.u;
+					pch->isum += v.u;
+				}
+			}
+		}
+		++pch;
+	}
+
+	++dec_count;
+}
+
+void TScope::StoreDecimated()  // called from RunIrqTask() at the end of the smp_cycles window
+{
+	TScopeChannelData * pch = &channels[0];
+	TScopeChannelData * pch_end = pch + channel_count;
+	while (pch < pch_end)
+	{
+		unsigned len = pch->bytelen;
+		if ((len > 4) || (0 == dec_count))
+		{
+			// not decimated: the current value (twice for min / max)
+			memcpy(next_smp_ptr, pch->varptr, len);
+			next_smp_ptr += len;
+			if (SCOPE_SMP_MODE_MINMAX == active_smp_mode)
+			{
+				memcpy(next_smp_ptr, pch->varptr, len);
+				next_smp_ptr += len;
+			}
+		}
+		else if (SCOPE_SMP_MODE_MINMAX == active_smp_mode)
+		{
+			memcpy(next_smp_ptr, &pch->vmin, len);  // little endian: the lower bytes
+			next_smp_ptr += len;
+			memcpy(next_smp_ptr, &pch->vmax, len);
+			next_smp_ptr += len;
+		}
+		else // average
+		{
+			TScopeValue avg;
+			if (PARF_TYPE_FLOAT == pch->valtype)
+			{
+				avg.f = pch->fsum / dec_count;
+			}
+			else if (PARF_TYPE_INT == pch->valtype)
+			{
+				avg.i = int32_t(pch->isum / dec_count);
+			}
+			else
+			{
+				avg.u = uint32_t(uint64_t(pch->isum) / dec_count);
+			}
+			memcpy(next_smp_ptr, &avg, len);
+			next_smp_ptr += len;
+		}
+		++pch;
+	}
+
+	dec_count = 0;
+}
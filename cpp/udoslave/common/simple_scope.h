@@ -28,7 +28,7 @@
 #ifndef SIMPLE_SCOPE_H_
 #define SIMPLE_SCOPE_H_
 
-#define SCOPE_VERSION   (1 * 1000000 + 0 * 1000 + 0)
+#define SCOPE_VERSION   (1 * 1000000 + 2 * 1000 + 0)
 
 #define SCOPE_MAX_CHANNELS     16
 
@@ -38,21 +38,59 @@
 #define SCOPE_STATE_WAITTRIG    5
 #define SCOPE_STATE_POSTFILL    7
 #define SCOPE_STATE_DATAREADY   8
+#define SCOPE_STATE_STREAMING   9
 
 #define SCOPE_CMD_STOP          0
 #define SCOPE_CMD_PERMREC       1
 #define SCOPE_CMD_START         3
 #define SCOPE_CMD_FORCETRIG     7
+#define SCOPE_CMD_STREAM        9  // continuous recording into a ring of buffer segments
+
+// sample modes, how the smp_cycles window is reduced to a sample
+#define SCOPE_SMP_MODE_SAMPLE   0  // the values at the end of the window (sub-sampling)
+#define SCOPE_SMP_MODE_MINMAX   1  // min / max envelope: two values (min, max) per channel in each sample
+#define SCOPE_SMP_MODE_AVERAGE  2  // average of the window
+
+#ifndef SCOPE_STREAM_SEGMENTS
+  #define SCOPE_STREAM_SEGMENTS   2  // power of 2, 2 = double buffering, more segments tolerate longer readout hiccups
+#endif
+
+// Packed readout (pfn_scope_data_packed) stream format:
+//   header: version (1), field count, field byte widths (1, 2 or 4), raw data length (varint)
+//   then for every sample and field: the difference to the same field of the previous sample,
+//   sign extended from the field width, zigzag and varint (LEB128) encoded
+#define SCOPE_PACK_VERSION      1
+#define SCOPE_PACK_MAX_FIELDS   (4 * SCOPE_MAX_CHANNELS)  // 8 byte channels are split, min / max doubles
+
+// Handoff between RunIrqTask() (producer) and the UDO handlers (consumer), which might run on different cores:
+// the data written before a release store is visible after the matching acquire load
+#define SCOPE_LOAD_ACQUIRE(v)       __atomic_load_n(&(v), __ATOMIC_ACQUIRE)
+#define SCOPE_STORE_RELEASE(v, x)   __atomic_store_n(&(v), (x), __ATOMIC_RELEASE)
 
 #include "udoslave.h"
 #include "simple_partable.h"
 
+typedef union TScopeValue
+{
+	int32_t          i;
+	uint32_t         u;
+	float            f;
+//
+} TScopeValue;
+
 typedef struct TScopeChannelData
 {
 	unsigned         datadef;
 	uint32_t         bytelen;
 	uint8_t *	       varptr;
 	TParameterDef *  pdef;
+
+	// decimation accumulators, 8 byte channels are only sub-sampled
+	uint8_t          valtype;  // PARF_TYPE_INT, PARF_TYPE_UINT or PARF_TYPE_FLOAT
+	TScopeValue      vmin;
+	TScopeValue      vmax;
+	int64_t          isum;
+	float            fsum;
 //
 } TScopeChannelData;
 
@@ -78,12 +116,44 @@ protected:  // internals
 
 
 	uint16_t            smp_cycle_counter = 0;
+	uint16_t            dec_count = 0;        // number of the accumulated values in the current window
+	uint8_t             active_smp_mode = SCOPE_SMP_MODE_SAMPLE;  // smp_mode latched at the start
 
 	unsigned 						presmp_count;
 	unsigned 						postsmp_count;
 
 	unsigned            cur_smp_index;
 
+	// streaming: single producer / single consumer ring of segments, the indexes are free running
+	uint32_t            stream_seg_bytes = 0;
+	uint8_t *           stream_seg_end;       // end of the segment being filled
+	uint32_t            stream_wr_idx = 0;    // published segments, written only by RunIrqTask() (release)
+	uint32_t            stream_rd_idx = 0;    // released segments, written only by the readout (release)
+	uint32_t            stream_rd_seq = 0;    // sequence number of the last released segment
+	uint32_t            stream_counter = 0;   // counts the filled segments, including the dropped ones
+	uint32_t            stream_seg_seq[SCOPE_STREAM_SEGMENTS];  // sequence numbers of the published segments
+
+	void                StreamSegmentDone();
+	void                AccumulateChannels();
+	void                StoreDecimated();
+
+	// packed readout, encoded sequentially chunk by chunk
+	uint8_t             pk_field_count = 0;
+	uint8_t             pk_field = 0;         // next field in the sample
+	uint16_t            pk_field_pos = 0;     // byte offset of the next field in the sample
+	uint8_t             pk_hdr_len = 0;
+	uint8_t             pk_hdr_pos = 0;
+	uint32_t            pk_offset = 0;        // packed stream offset of the next chunk
+	uint32_t            pk_smp = 0;           // next sample index
+	uint8_t *           pk_smp_ptr = nullptr;
+	uint8_t             pk_widths[SCOPE_PACK_MAX_FIELDS];
+	uint32_t            pk_prev[SCOPE_PACK_MAX_FIELDS];
+	uint8_t             pk_hdr[2 + SCOPE_PACK_MAX_FIELDS + 5];
+
+	void                PackStart();
+	unsigned            PackChunk(uint8_t * dst, unsigned maxlen);  // dst = nullptr: skip only
+	uint8_t *           StreamSegmentPtr(uint32_t aidx)  { return pbuffer + (aidx % SCOPE_STREAM_SEGMENTS) * stream_seg_bytes; }
+
 public:
 	uint8_t *           pbuffer = nullptr;
 	uint32_t            buffer_size = 0;
@@ -97,11 +167,17 @@ public:  // state + cmd
 	uint32_t 						sample_width = 0;
 	uint32_t            trigger_index = 0;
 
+	// streaming: the master polls pfn_scope_stream_ack until the sequence number changes (oldest ready segment),
+	// reads the segment via pfn_scope_data then releases it by writing the sequence number back
+	uint32_t            stream_seq = 0;       // sequence number of the last published segment, 0 = none
+	uint32_t            stream_overflow = 0;  // number of the segments lost because the readout was too slow
+
 public: // configuration
 	uint8_t             trigger_channel = 0;
 	uint8_t             trigger_slope = 0;
 	uint32_t            pretrigger_percent = 50;
 	uint16_t            smp_cycles = 1;
+	uint8_t             smp_mode = SCOPE_SMP_MODE_SAMPLE;
 	uint32_t            max_samples = 0;  // 0 =
 	int32_t             trigger_level = 0;
 	uint32_t            trigger_mask = 0xFFFFFFFF;
@@ -121,11 +197,13 @@ public:
 	bool SetChannelDef(unsigned achnum, unsigned adef);
 
 	bool pfn_scope_data(TUdoRequest * udorq, TParameterDef * pdef, void * varptr);
+	bool pfn_scope_data_packed(TUdoRequest * udorq, TParameterDef * pdef, void * varptr);
 
 	void PrepareSampling();
 
 	bool pfn_scope_def(TUdoRequest * udorq, TParameterDef * pdef, void * varptr);
 	bool pfn_scope_cmd(TUdoRequest * udorq, TParameterDef * pdef, void * varptr);
+	bool pfn_scope_stream_ack(TUdoRequest * udorq, TParameterDef * pdef, void * varptr);
 };
 
 extern TScope g_scope;
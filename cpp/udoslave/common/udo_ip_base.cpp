@@ -33,6 +33,8 @@
 
 uint8_t udoip_rq_buffer[UDOIP_MAX_RQ_SIZE];
 uint8_t udoip_ans_cache_buffer[UDOIP_ANSCACHE_NUM * UDOIP_MAX_RQ_SIZE]; // this might be relative big!
+TUdoIpSlaveCacheRec  udoip_ans_cache_recs[UDOIP_ANSCACHE_NUM];
+uint16_t             udoip_ans_cache_hash[UDOIP_ANSCACHE_HASH_SIZE];
 
 TUdoIpCommBase::TUdoIpCommBase()
 {
@@ -45,23 +47,74 @@ TUdoIpCommBase::~TUdoIpCommBase()
 
 }
 
+bool TUdoIpCommBase::SetAnsCacheStorage(TUdoIpSlaveCacheRec * arecs, unsigned anum, uint8_t * abuffer,
+                                        uint16_t * ahash, unsigned ahashsize, unsigned arecsize)
+{
+  if (!arecs || !abuffer || !ahash
+      || (anum < 1) || (anum >= UDOIP_ANSCACHE_NONE)            // the record links are 16 bit
+      || (ahashsize < 1) || (ahashsize & (ahashsize - 1))       // the hash is masked
+      || (arecsize < UDOIP_MAX_RQ_SIZE))                        // the normal answers must fit
+  {
+    return false;
+  }
+
+  ans_cache = arecs;
+  ans_cache_num = anum;
+  ans_cache_buffer = abuffer;
+  ans_cache_recsize = arecsize;
+  ans_hash = ahash;
+  ans_hash_mask = ahashsize - 1;
+  return true;
+}
+
 bool TUdoIpCommBase::Init()
 {
   initialized = false;
 
-  rqbuf = &udoip_rq_buffer[0];
-  rqbufsize = sizeof(udoip_rq_buffer);
+  if (!rqbuf)
+  {
+    rqbuf = &udoip_rq_buffer[0];
+    rqbufsize = sizeof(udoip_rq_buffer);
+  }
 
-  // initialize the ans_cache
+  if (!ans_cache)
+  {
+    if (!SetAnsCacheStorage(&udoip_ans_cache_recs[0], UDOIP_ANSCACHE_NUM, &udoip_ans_cache_buffer[0],
+                            &udoip_ans_cache_hash[0], UDOIP_ANSCACHE_HASH_SIZE))
+    {
+      return false;  // invalid UDOIP_ANSCACHE_NUM or UDOIP_ANSCACHE_HASH_SIZE
+    }
+  }
+
+  if (max_payload_ext)  // the large requests and answers must fit into the buffers
+  {
+    if (max_payload_ext > UDOIP_MAX_PAYLOAD_EXT_LIMIT)      max_payload_ext = UDOIP_MAX_PAYLOAD_EXT_LIMIT;
+    if (max_payload_ext + 20 > rqbufsize)                   max_payload_ext = rqbufsize - 20;
+    if (max_payload_ext + 16 > ans_cache_recsize)           max_payload_ext = ans_cache_recsize - 16;
+    if (max_payload_ext <= UDO_MAX_DATALEN)                 max_payload_ext = 0;
+  }
+
+  // initialize the ans_cache, all records go to the LRU list, none to the hash
+
+  for (unsigned n = 0; n <= ans_hash_mask; ++n)
+  {
+    ans_hash[n] = UDOIP_ANSCACHE_NONE;
+  }
+
+  ans_lru_first = UDOIP_ANSCACHE_NONE;
+  ans_lru_last  = UDOIP_ANSCACHE_NONE;
 
   uint32_t offs = 0;
-  for (unsigned n = 0; n < UDOIP_ANSCACHE_NUM; ++n)
+  for (unsigned n = 0; n < ans_cache_num; ++n)
   {
-    memset(&ans_cache[n], 0, sizeof(ans_cache[n]));
-    ans_cache[n].dataptr = &udoip_ans_cache_buffer[offs];
-    ans_cache[n].idx = n;
-    offs += UDOIP_MAX_RQ_SIZE;
-    ans_cache_lru_idx[n] = n;
+    TUdoIpSlaveCacheRec * pac = &ans_cache[n];
+    memset(pac, 0, sizeof(*pac));
+    pac->dataptr = &ans_cache_buffer[offs];
+    pac->idx = n;
+    pac->hbucket = UDOIP_ANSCACHE_NONE;
+    pac->hnext = UDOIP_ANSCACHE_NONE;
+    offs += ans_cache_recsize;
+    AnsCacheLruAppend(pac);
   }
 
   if (!UdpInit())
@@ -123,68 +176,153 @@ void TUdoIpCommBase::ProcessUdpRequest(TUdoIpRequest * ucrq)
 	// allocate an answer cache record
 	pansc = AllocateAnsCache(ucrq, prqh);
 
-	TUdoIpRqHeader * pansh = (TUdoIpRqHeader *)pansc->dataptr;
+	pansc->datalen = ExecRequest(&mudorq, ucrq, pansc->dataptr);
+
+	// send the response
+  r = UdpRespond(pansc->dataptr, pansc->datalen);
+	if (r <= 0)
+	{
+		TRACE("UdoIpSlave: error sending back the answer: %i!\r\n", r);
+	}
+}
+
+unsigned TUdoIpCommBase::ExecRequest(TUdoRequest * udorq, TUdoIpRequest * ucrq, uint8_t * ansbuf)
+{
+	TUdoIpRqHeader * prqh = (TUdoIpRqHeader *)ucrq->dataptr;
+	TUdoIpRqHeader * pansh = (TUdoIpRqHeader *)ansbuf;
 	*pansh = *prqh;  // initialize the answer header with the request header
 	uint8_t * pansdata = (uint8_t *)(pansh + 1); // the data comes right after the header
+	uint8_t * prqdata = (uint8_t *)(prqh + 1);   // the request data (or the extended length)
+	unsigned  rqhsize = sizeof(TUdoIpRqHeader);
 
 	// execute the UDO request
 
-	memset(&mudorq, 0, sizeof(mudorq));
-	mudorq.index  = prqh->index;
-	mudorq.offset = prqh->offset;
-	mudorq.rqlen = (prqh->len_cmd & 0x7FF);
-	mudorq.maxanslen = mudorq.rqlen;
-	mudorq.iswrite = ((prqh->len_cmd >> 15) & 1);
-	mudorq.metalen = ((0x8420 >> ((prqh->len_cmd >> 13) & 3) * 4) & 0xF);
-	mudorq.metadata = prqh->metadata;
+	memset(udorq, 0, sizeof(*udorq));
+	udorq->index  = prqh->index;
+	udorq->offset = prqh->offset;
+	udorq->iswrite = ((prqh->len_cmd >> 15) & 1);
+	udorq->metalen = ((0x8420 >> ((prqh->len_cmd >> 13) & 3) * 4) & 0xF);
+	udorq->metadata = prqh->metadata;
+
+	uint32_t rqlen = (prqh->len_cmd & 0x7FF);
+	if (UDOIP_LEN_EXT == rqlen)  // the extended length follows the header
+	{
+		rqhsize += 4;
+		if (ucrq->datalen < rqhsize)
+		{
+			rqlen = 0;
+		}
+		else
+		{
+			memcpy(&rqlen, prqdata, 4);
+			prqdata += 4;
+		}
+	}
 
-	if (mudorq.iswrite)
+	if (udorq->iswrite)
 	{
 		// write
-		mudorq.dataptr = (uint8_t *)(prqh + 1); // the data comes after the header
-		mudorq.rqlen = ucrq->datalen - sizeof(TUdoIpRqHeader);  // override the datalen from the header
+		udorq->dataptr = prqdata;
+		rqlen = (ucrq->datalen > rqhsize ? ucrq->datalen - rqhsize : 0);  // override the datalen from the header
 	}
 	else
 	{
 		// read
-		mudorq.dataptr = pansdata;
+		udorq->dataptr = pansdata;
+		if (rqlen > ans_cache_recsize - sizeof(TUdoIpRqHeader))
+		{
+			rqlen = ans_cache_recsize - sizeof(TUdoIpRqHeader);  // the answer must fit into the cache record
+		}
 	}
+	udorq->rqlen = rqlen;
+	udorq->maxanslen = rqlen;
 
-	udoslave_app_read_write(&mudorq);
-
-	if (mudorq.result)
+	if (0x0005 == udorq->index)  // large payload, property of the transport
 	{
-		mudorq.anslen = 2;
-		pansh->len_cmd |= 0x7FF; // abort response
-		*(uint16_t *)pansdata = mudorq.result;
+		if (max_payload_ext)
+		{
+			udo_ro_uint(udorq, max_payload_ext, 4);
+		}
+		else
+		{
+			udo_response_error(udorq, UDOERR_INDEX);
+		}
+	}
+	else if ((0x0003 == udorq->index) && !udorq->iswrite && udorq->offset)
+	{
+		// multi-read with the item list appended to the read request, the offset holds the item count
+		if ( (udorq->offset > UDO_MULTIREAD_MAX_ITEMS)
+		     || (ucrq->datalen < rqhsize + udorq->offset * sizeof(TUdoMultiReadItem)) )
+		{
+			udo_response_error(udorq, UDOERR_WRONG_OFFSET);
+		}
+		else
+		{
+			AppMultiRead(udorq, (TUdoMultiReadItem *)prqdata, udorq->offset);
+		}
+	}
+	else
+	{
+		AppReadWrite(udorq);
 	}
 
-	pansc->datalen = mudorq.anslen + sizeof(TUdoIpRqHeader);
+	if (!udorq->result && !udorq->iswrite && (udorq->dataptr != pansdata) && udorq->anslen)
+	{
+		memcpy(pansdata, udorq->dataptr, udorq->anslen);  // redirected answer, the cache needs a copy
+	}
 
-	// send the response
-  r = UdpRespond(pansc->dataptr, pansc->datalen);
-	if (r <= 0)
+	if (udorq->result)
 	{
-		TRACE("UdoIpSlave: error sending back the answer: %i!\r\n", r);
+		udorq->anslen = 2;
+		pansh->len_cmd |= 0x7FF; // abort response
+		*(uint16_t *)pansdata = udorq->result;
 	}
+
+	return udorq->anslen + sizeof(TUdoIpRqHeader);
+}
+
+unsigned TUdoIpCommBase::AnsCacheHash(uint32_t asrcip, uint16_t asrcport, uint32_t arqid)
+{
+	uint32_t h = (asrcip ^ (uint32_t(asrcport) << 16) ^ arqid) * 2654435761u;  // multiplicative hash
+	return ((h >> 16) & ans_hash_mask);
+}
+
+void TUdoIpCommBase::AnsCacheLruUnlink(TUdoIpSlaveCacheRec * pac)
+{
+	if (pac->lru_prev != UDOIP_ANSCACHE_NONE)  ans_cache[pac->lru_prev].lru_next = pac->lru_next;
+	else                                        ans_lru_first = pac->lru_next;
+
+	if (pac->lru_next != UDOIP_ANSCACHE_NONE)  ans_cache[pac->lru_next].lru_prev = pac->lru_prev;
+	else                                        ans_lru_last = pac->lru_prev;
+}
+
+void TUdoIpCommBase::AnsCacheLruAppend(TUdoIpSlaveCacheRec * pac)
+{
+	pac->lru_prev = ans_lru_last;
+	pac->lru_next = UDOIP_ANSCACHE_NONE;
+	if (ans_lru_last != UDOIP_ANSCACHE_NONE)  ans_cache[ans_lru_last].lru_next = pac->idx;
+	else                                       ans_lru_first = pac->idx;
+	ans_lru_last = pac->idx;
 }
 
 TUdoIpSlaveCacheRec * TUdoIpCommBase::FindAnsCache(TUdoIpRequest * iprq, TUdoIpRqHeader * prqh)
 {
-	TUdoIpSlaveCacheRec * pac = &ans_cache[0];
-	TUdoIpSlaveCacheRec * last_pac = pac + UDOIP_ANSCACHE_NUM;
-	while (pac < last_pac)
+	uint16_t idx = ans_hash[AnsCacheHash(iprq->srcip, iprq->srcport, prqh->rqid)];
+	while (idx != UDOIP_ANSCACHE_NONE)
 	{
+		TUdoIpSlaveCacheRec * pac = &ans_cache[idx];
 		if ( (pac->srcip == iprq->srcip) and (pac->srcport == iprq->srcport)
 				 and (pac->rqh.rqid == prqh->rqid) and (pac->rqh.len_cmd == prqh->len_cmd)
 				 and (pac->rqh.index == prqh->index) and (pac->rqh.offset == prqh->offset)
-				 and (pac->datalen == iprq->datalen)
+				 and (pac->rqdatalen == iprq->datalen)
 			 )
 		{
 			// found the previous request, the response was probably lost
+			AnsCacheLruUnlink(pac);  // keep the active clients in the cache
+			AnsCacheLruAppend(pac);
 			return pac;
 		}
-		++pac;
+		idx = pac->hnext;
 	}
 
 	return nullptr;
@@ -192,17 +330,31 @@ TUdoIpSlaveCacheRec * TUdoIpCommBase::FindAnsCache(TUdoIpRequest * iprq, TUdoIpR
 
 TUdoIpSlaveCacheRec * TUdoIpCommBase::AllocateAnsCache(TUdoIpRequest * iprq, TUdoIpRqHeader * prqh)
 {
-	// re-use the oldest entry
-	uint8_t idx = ans_cache_lru_idx[0]; // the oldest entry
-	memcpy(&ans_cache_lru_idx[0], &ans_cache_lru_idx[1], UDOIP_ANSCACHE_NUM - 1); // rotate the array
-	ans_cache_lru_idx[UDOIP_ANSCACHE_NUM-1] = idx; // append to the end
+	// re-use the oldest entry, move it to the end of the LRU list
+	TUdoIpSlaveCacheRec * pac = &ans_cache[ans_lru_first];
+	AnsCacheLruUnlink(pac);
+	AnsCacheLruAppend(pac);
 
-	TUdoIpSlaveCacheRec * pac = &ans_cache[idx];
+	// remove from the previous hash chain
+	if (pac->hbucket != UDOIP_ANSCACHE_NONE)
+	{
+		uint16_t * plink = &ans_hash[pac->hbucket];
+		while (*plink != pac->idx)
+		{
+			plink = &ans_cache[*plink].hnext;
+		}
+		*plink = pac->hnext;
+	}
 
 	pac->srcip   = iprq->srcip;
 	pac->srcport = iprq->srcport;
 	pac->rqh     = *prqh;
+	pac->rqdatalen = iprq->datalen;
+
+	// insert to the new hash chain
+	pac->hbucket = AnsCacheHash(pac->srcip, pac->srcport, prqh->rqid);
+	pac->hnext = ans_hash[pac->hbucket];
+	ans_hash[pac->hbucket] = pac->idx;
 
 	return pac;
 }
-
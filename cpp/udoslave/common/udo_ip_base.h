@@ -58,15 +58,22 @@ typedef struct
 #define UDOIP_DEFAULT_PORT  1221
 #define UDOIP_MAX_RQ_SIZE  (1024 + 16)  // 1024 byte payload + 16 byte header
 
+#define UDOIP_MAX_PAYLOAD_EXT_LIMIT  (65507 - 20)  // UDP datagram limit - header - extended length
+
 #ifndef UDOIP_ANSCACHE_NUM
   #define UDOIP_ANSCACHE_NUM  4  // this is also the parallel clients supported
                                  // requires 6kByte RAM (= 4 * 1.5 k)
 #endif
 
+#ifndef UDOIP_ANSCACHE_HASH_SIZE
+  #define UDOIP_ANSCACHE_HASH_SIZE  8  // must be a power of 2
+#endif
+
+#define UDOIP_ANSCACHE_NONE  0xFFFF    // empty record link
+
 typedef struct
 {
-	uint8_t         idx;
-	uint8_t         _reserved;
+	uint16_t        idx;
 	uint16_t        srcport;
 
 	uint32_t        srcip;
@@ -74,7 +81,14 @@ typedef struct
 	TUdoIpRqHeader  rqh;
 
   uint16_t        datalen;  // data length with header
+  uint16_t        rqdatalen;  // request length with header, for the repeat detection
   uint8_t *       dataptr;
+
+  // record indexes for the hash chain and for the LRU list
+  uint16_t        hbucket;  // UDOIP_ANSCACHE_NONE = not in the hash yet
+  uint16_t        hnext;
+  uint16_t        lru_prev;
+  uint16_t        lru_next;
 //
 } TUdoIpSlaveCacheRec;
 
@@ -83,25 +97,43 @@ class TUdoIpCommBase
 public:
 	uint16_t              port = UDOIP_DEFAULT_PORT;
 
+	// large payload (object 0x0005), 0 = not supported. The rqbuf must hold max_payload_ext + 20 bytes
+	// and the answer cache records max_payload_ext + 16 bytes, otherwise Init() reduces it.
+	uint32_t              max_payload_ext = 0;
+
 public:
 	bool                  initialized = false;
 
 	TUdoIpRequest         miprq;
 	TUdoRequest           mudorq;
 
-	uint8_t *             rqbuf = nullptr;
+	uint8_t *             rqbuf = nullptr;      // might be set before Init(), otherwise a global buffer is used
 	uint32_t              rqbufsize = 0;
 
-	uint8_t               ans_cache_lru_idx[UDOIP_ANSCACHE_NUM];
-	TUdoIpSlaveCacheRec   ans_cache[UDOIP_ANSCACHE_NUM];
+	// answer cache, hashed on (srcip, srcport, rqid), by default with UDOIP_ANSCACHE_NUM records
+	// in global buffers, other sizes can be set with SetAnsCacheStorage() before Init()
+	TUdoIpSlaveCacheRec * ans_cache = nullptr;
+	unsigned              ans_cache_num = 0;
+	uint8_t *             ans_cache_buffer = nullptr;  // ans_cache_num * ans_cache_recsize
+	unsigned              ans_cache_recsize = UDOIP_MAX_RQ_SIZE;
+	uint16_t *            ans_hash = nullptr;          // bucket heads
+	unsigned              ans_hash_mask = 0;
+	uint16_t              ans_lru_first = UDOIP_ANSCACHE_NONE;  // the oldest
+	uint16_t              ans_lru_last  = UDOIP_ANSCACHE_NONE;  // the newest
 
 	uint32_t              last_request_mstime = 0;
 
 	TUdoIpCommBase();
 	virtual ~TUdoIpCommBase();
 
+	// returns false (and keeps the previous storage) when anum is 0 or not below UDOIP_ANSCACHE_NONE,
+	// ahashsize is not a power of 2 or arecsize is smaller than UDOIP_MAX_RQ_SIZE
+	bool SetAnsCacheStorage(TUdoIpSlaveCacheRec * arecs, unsigned anum, uint8_t * abuffer,
+	                        uint16_t * ahash, unsigned ahashsize,  // ahashsize must be a power of 2
+	                        unsigned arecsize = UDOIP_MAX_RQ_SIZE);
+
 	bool Init();
-	void Run(); // must be called regularly
+	virtual void Run(); // must be called regularly
 
 public: // platform specific, these must be overridden
 
@@ -113,7 +145,22 @@ public:
 	TUdoIpSlaveCacheRec *  FindAnsCache(TUdoIpRequest * iprq, TUdoIpRqHeader * prqh);
 	TUdoIpSlaveCacheRec *  AllocateAnsCache(TUdoIpRequest * iprq, TUdoIpRqHeader * prqh);
 
-  void         ProcessUdpRequest(TUdoIpRequest * ucrq);
+protected:
+	unsigned               AnsCacheHash(uint32_t asrcip, uint16_t asrcport, uint32_t arqid);
+	void                   AnsCacheLruUnlink(TUdoIpSlaveCacheRec * pac);
+	void                   AnsCacheLruAppend(TUdoIpSlaveCacheRec * pac);
+
+  virtual void  ProcessUdpRequest(TUdoIpRequest * ucrq);
+
+  // the request handlers, by default the global udoslave_app_...() functions
+  virtual void  AppReadWrite(TUdoRequest * udorq)  { udoslave_app_read_write(udorq); }
+  virtual void  AppMultiRead(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count)
+  {
+    udoslave_app_multi_read(udorq, items, count);
+  }
+
+  // executes the request, prepares the answer (with header) into the ansbuf, returns the answer length
+  unsigned      ExecRequest(TUdoRequest * udorq, TUdoIpRequest * ucrq, uint8_t * ansbuf);
 };
 
 #endif /* UDO_IP_BASE_H_ */
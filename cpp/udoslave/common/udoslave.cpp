@@ -159,6 +159,63 @@ bool udo_rw_data_zp(TUdoRequest * udorq, void * dataptr, unsigned datalen)
   return udo_rw_data(udorq, dataptr, datalen);
 }
 
+void udo_blobrx_init(TUdoBlobRx * brx, void * dataptr, uint32_t datalen, uint32_t * blockmap, uint32_t blocksize)
+{
+	brx->dataptr = (uint8_t *)dataptr;
+	brx->datalen = datalen;
+	brx->blockmap = blockmap;
+	brx->blocksize = (blocksize ? blocksize : 1);
+	brx->blockcount = (datalen + brx->blocksize - 1) / brx->blocksize;
+	udo_blobrx_reset(brx);
+}
+
+void udo_blobrx_reset(TUdoBlobRx * brx)
+{
+	memset(brx->blockmap, 0, ((brx->blockcount + 31) >> 5) * 4);
+	brx->blocks_done = 0;
+}
+
+bool udo_blobrx_complete(TUdoBlobRx * brx)
+{
+	return (brx->blocks_done >= brx->blockcount);
+}
+
+bool udo_rw_blob(TUdoRequest * udorq, TUdoBlobRx * brx)
+{
+	if (!udorq->iswrite)
+	{
+		return udo_rw_data(udorq, brx->dataptr, brx->datalen);
+	}
+
+	if (!udo_rw_data(udorq, brx->dataptr, brx->datalen))
+	{
+		return false;
+	}
+
+	// mark the blocks which are completely covered by this chunk, the last block might be shorter
+	uint32_t endoffs = udorq->offset + udorq->rqlen;
+	uint32_t block = (udorq->offset + brx->blocksize - 1) / brx->blocksize;
+	while (block < brx->blockcount)
+	{
+		uint32_t blockend = (block + 1) * brx->blocksize;
+		if (blockend > brx->datalen)  blockend = brx->datalen;
+		if (blockend > endoffs)
+		{
+			break;
+		}
+
+		uint32_t bit = (1u << (block & 31));
+		if (0 == (brx->blockmap[block >> 5] & bit))  // repeated chunks are counted only once
+		{
+			brx->blockmap[block >> 5] |= bit;
+			++brx->blocks_done;
+		}
+		++block;
+	}
+
+	return true;
+}
+
 bool udo_ro_data(TUdoRequest * udorq, void * dataptr, unsigned datalen)
 {
 	if (!udorq->iswrite)
@@ -325,6 +382,169 @@ bool udoslave_handle_blobtest(TUdoRequest * udorq) // object 0002
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+
+TUdoMultiReadItem  udoslave_multiread_list[UDO_MULTIREAD_MAX_ITEMS];
+unsigned           udoslave_multiread_count = 0;
+
+bool udoslave_multi_read(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count)
+{
+	if (udorq->iswrite)
+	{
+		return udo_response_error(udorq, UDOERR_READ_ONLY);
+	}
+
+	TUdoRequest        subrq;
+	TUdoMultiReadItem  item;
+	unsigned           anspos = 0;
+
+	for (unsigned n = 0; n < count; ++n)
+	{
+		memcpy(&item, &items[n], sizeof(item));  // the list might be unaligned
+
+		// the whole item must fit, the data part is kept 4 byte aligned
+		if (anspos + sizeof(TUdoMultiReadAnsHead) + ((item.len + 3) & 0xFFFC) > udorq->maxanslen)
+		{
+			break;
+		}
+
+		memset(&subrq, 0, sizeof(subrq));
+		subrq.index = item.index;
+		subrq.offset = item.offset;
+		subrq.rqlen = item.len;
+		subrq.maxanslen = item.len;
+		uint8_t * pdata = udorq->dataptr + anspos + sizeof(TUdoMultiReadAnsHead);
+		subrq.dataptr = pdata;
+
+		udoslave_app_read_write(&subrq);
+
+		TUdoMultiReadAnsHead * phead = (TUdoMultiReadAnsHead *)(udorq->dataptr + anspos);
+		if (subrq.result)
+		{
+			subrq.anslen = 0;
+		}
+		else
+		{
+			if (subrq.anslen > item.len)
+			{
+				subrq.anslen = item.len;
+			}
+
+			if (subrq.dataptr != pdata)
+			{
+				memcpy(pdata, subrq.dataptr, subrq.anslen);  // redirected answer
+			}
+		}
+		phead->len = subrq.anslen;
+		phead->result = subrq.result;
+
+		anspos += sizeof(TUdoMultiReadAnsHead) + ((subrq.anslen + 3) & 0xFFFC);
+	}
+
+	udorq->anslen = anspos;
+	udorq->result = 0;
+	return true;
+}
+
+__attribute__((weak))
+bool udoslave_app_multi_read(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count)
+{
+	return udoslave_multi_read(udorq, items, count);
+}
+
+bool udoslave_handle_multiread(TUdoRequest * udorq) // object 0003
+{
+	if (udorq->offset)
+	{
+		return udo_response_error(udorq, UDOERR_WRONG_OFFSET);
+	}
+
+	if (udorq->iswrite)  // store the list
+	{
+		if ((udorq->rqlen % sizeof(TUdoMultiReadItem)) || (udorq->rqlen > sizeof(udoslave_multiread_list)))
+		{
+			return udo_response_error(udorq, UDOERR_WRITE_VALUE);
+		}
+
+		memcpy(&udoslave_multiread_list[0], udorq->dataptr, udorq->rqlen);
+		udoslave_multiread_count = udorq->rqlen / sizeof(TUdoMultiReadItem);
+		return udo_response_ok(udorq);
+	}
+
+	return udoslave_multi_read(udorq, &udoslave_multiread_list[0], udoslave_multiread_count);
+}
+
+__attribute__((weak))
+bool udoslave_app_object_desc(uint16_t aindex, uint32_t * rdesc)
+{
+	return false;
+}
+
+bool udoslave_handle_objdesc(TUdoRequest * udorq) // object 0004
+{
+	if (udorq->iswrite)
+	{
+		return udo_response_error(udorq, UDOERR_READ_ONLY);
+	}
+
+	uint32_t desc = 0;
+	if ((udorq->offset > 0xFFFF) || !udoslave_app_object_desc(udorq->offset, &desc))
+	{
+		return udo_response_error(udorq, UDOERR_WRONG_OFFSET);
+	}
+
+	return udo_ro_uint(udorq, desc, 4);
+}
+
+bool udoslave_handle_blobcrc(TUdoRequest * udorq) // object 0006
+{
+	if (udorq->iswrite)
+	{
+		return udo_response_error(udorq, UDOERR_READ_ONLY);
+	}
+
+	// the range comes with the request: offset = start, metadata = index + (length << 16)
+	if ((udorq->metadata >> 16) > UDO_BLOBCRC_MAX_LEN)
+	{
+		return udo_response_error(udorq, UDOERR_WRONG_ACCESS);
+	}
+
+	// read the range back from the object chunk by chunk
+	TUdoRequest  subrq;
+	uint32_t     chunk[16];
+	uint32_t     crc = 0;
+	uint32_t     offs = udorq->offset;
+	uint32_t     remaining = (udorq->metadata >> 16);
+
+	while (remaining > 0)
+	{
+		uint32_t chunksize = (remaining > sizeof(chunk) ? sizeof(chunk) : remaining);
+
+		memset(&subrq, 0, sizeof(subrq));
+		subrq.index = (udorq->metadata & 0xFFFF);
+		subrq.offset = offs;
+		subrq.rqlen = chunksize;
+		subrq.maxanslen = chunksize;
+		subrq.dataptr = (uint8_t *)&chunk[0];
+
+		udoslave_app_read_write(&subrq);
+		if (subrq.result)
+		{
+			return udo_response_error(udorq, subrq.result);
+		}
+		if ((subrq.anslen <= 0) || (subrq.anslen > chunksize))
+		{
+			return udo_response_error(udorq, UDOERR_WRONG_OFFSET);  // the object is shorter
+		}
+
+		crc = udo_calc_crc32(crc, subrq.dataptr, subrq.anslen);  // the answer might be redirected
+		offs += subrq.anslen;
+		remaining -= subrq.anslen;
+	}
+
+	return udo_ro_uint(udorq, crc, 4);
+}
+
 bool udoslave_handle_base_objects(TUdoRequest * udorq)
 {
   if (0x0000 == udorq->index) // communication test
@@ -339,6 +559,18 @@ bool udoslave_handle_base_objects(TUdoRequest * udorq)
   {
     return udoslave_handle_blobtest(udorq);
   }
+  else if (0x0003 == udorq->index) // multi-read
+  {
+    return udoslave_handle_multiread(udorq);
+  }
+  else if (0x0004 == udorq->index) // object descriptor
+  {
+    return udoslave_handle_objdesc(udorq);
+  }
+  else if (0x0006 == udorq->index) // blob checksum
+  {
+    return udoslave_handle_blobcrc(udorq);
+  }
   else
   {
     return udo_response_error(udorq, UDOERR_INDEX);
@@ -43,12 +43,40 @@ bool      udo_rw_data_zp(TUdoRequest * udorq, void * dataptr, unsigned datalen);
 bool      udo_ro_data(TUdoRequest * udorq, void * dataptr, unsigned datalen);
 bool      udo_wo_data(TUdoRequest * udorq, void * dataptr, unsigned datalen);
 bool      udo_response_cstring(TUdoRequest * udorq, const char * astr);
+
+// blob reception (e.g. firmware upload) where the chunks might arrive in any order and repeated,
+// the received blocks are tracked in a bitmap provided by the application: (datalen / blocksize + 32) / 32 words
+typedef struct TUdoBlobRx
+{
+	uint8_t *   dataptr;
+	uint32_t    datalen;
+	uint32_t *  blockmap;     // one bit for every block
+	uint32_t    blocksize;    // tracking granularity, the chunks should be multiple of it (like the UDO payload size)
+	uint32_t    blockcount;
+	uint32_t    blocks_done;  // number of the different blocks received
+//
+} TUdoBlobRx;
+
+void      udo_blobrx_init(TUdoBlobRx * brx, void * dataptr, uint32_t datalen, uint32_t * blockmap, uint32_t blocksize);
+void      udo_blobrx_reset(TUdoBlobRx * brx);  // forgets the received blocks, for a new upload
+bool      udo_blobrx_complete(TUdoBlobRx * brx);
+bool      udo_rw_blob(TUdoRequest * udorq, TUdoBlobRx * brx);  // like udo_rw_data() but tracks the written blocks
+
 int32_t   udorq_intvalue(TUdoRequest * udorq);
 uint32_t  udorq_uintvalue(TUdoRequest * udorq);
 float     udorq_f32value(TUdoRequest * udorq);
 double    udorq_f64value(TUdoRequest * udorq);
 
 bool      udoslave_handle_base_objects(TUdoRequest * udorq);
+bool      udoslave_multi_read(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count);
+
+// executes a multi-read list which came with the request (UDO-IP), WEAK implementation by default,
+// gateways might override it to forward the whole list at once
+bool      udoslave_app_multi_read(TUdoRequest * udorq, TUdoMultiReadItem * items, unsigned count);
+
+// provides the UDO_OBJDESC_ flags for the object 0x0004, WEAK implementation by default (no descriptors),
+// applications with parameter tables can return param_object_desc() here
+bool      udoslave_app_object_desc(uint16_t aindex, uint32_t * rdesc);
 
 // the udo_slave_app_read_write must be defined somwhere in the application
 // so that can handle the application specific requests
@@ -28,6 +28,7 @@
 #include "string.h"
 #include "udo_ip_comm.h"
 #include <fcntl.h>
+#include <errno.h>
 #include "traces.h"
 
 #include "udoslaveapp.h"
@@ -83,7 +84,195 @@ int TUdoIpComm::UdpRecv()
 
 int TUdoIpComm::UdpRespond(void * srcbuf, unsigned buflen)
 {
+#if UDOIP_USE_MMSG
+  if (batching && (buflen <= sizeof(tx_buf[0])))  // the larger ones are sent directly
+  {
+    if (tx_count >= UDOIP_BATCH_SIZE)
+    {
+      FlushResponses();
+    }
+
+    memcpy(&tx_buf[tx_count][0], srcbuf, buflen);
+    tx_addr[tx_count] = client_addr;
+    tx_iov[tx_count].iov_len = buflen;
+    ++tx_count;
+    return buflen;
+  }
+#endif
+
   // dst address and port is already set
   int  r = sendto(fdsocket, (char *)srcbuf, buflen, 0, (struct sockaddr*)&client_addr, client_struct_length);
   return r;
 }
+
+bool TUdoIpComm::SetLargePayload(uint32_t amaxlen, unsigned aanscache_num)
+{
+  if (initialized)
+  {
+    return false;  // the answer cache is already in use
+  }
+
+  if (amaxlen > UDOIP_MAX_PAYLOAD_EXT_LIMIT)  amaxlen = UDOIP_MAX_PAYLOAD_EXT_LIMIT;
+  if (aanscache_num < 1)  aanscache_num = 1;
+  if (aanscache_num >= UDOIP_ANSCACHE_NONE)  aanscache_num = UDOIP_ANSCACHE_NONE - 1;
+
+  unsigned hashsize = 8;
+  while (hashsize < 2 * aanscache_num)
+  {
+    hashsize <<= 1;
+  }
+
+  unsigned recsize = amaxlen + sizeof(TUdoIpRqHeader);
+  if (recsize < UDOIP_MAX_RQ_SIZE)  recsize = UDOIP_MAX_RQ_SIZE;
+
+  TUdoIpSlaveCacheRec * recs = new TUdoIpSlaveCacheRec[aanscache_num];
+  uint8_t *  cachebuf = new uint8_t[aanscache_num * recsize];
+  uint16_t * hash = new uint16_t[hashsize];
+  if (!SetAnsCacheStorage(recs, aanscache_num, cachebuf, hash, hashsize, recsize))
+  {
+    delete[] recs;
+    delete[] cachebuf;
+    delete[] hash;
+    return false;
+  }
+
+  FreeLargePayload();  // of the previous call, not used anymore
+  large_recs = recs;
+  large_cachebuf = cachebuf;
+  large_hash = hash;
+
+  rqbufsize = amaxlen + sizeof(TUdoIpRqHeader) + 4;  // + extended length
+  rqbuf = new uint8_t[rqbufsize];
+  large_rqbuf = rqbuf;
+
+  max_payload_ext = amaxlen;
+  return true;
+}
+
+void TUdoIpComm::FreeLargePayload()
+{
+  delete[] large_recs;
+  delete[] large_cachebuf;
+  delete[] large_hash;
+  delete[] large_rqbuf;
+  large_recs = nullptr;
+  large_cachebuf = nullptr;
+  large_hash = nullptr;
+  large_rqbuf = nullptr;
+}
+
+TUdoIpComm::~TUdoIpComm()
+{
+  FreeLargePayload();
+}
+
+#if UDOIP_USE_MMSG
+
+void TUdoIpComm::Run()
+{
+  if (max_payload_ext || (ans_cache_recsize > UDOIP_MAX_RQ_SIZE))  // the batch buffers are too small for the large requests / answers
+  {
+    while (UdpRecv() > 0)
+    {
+      ProcessUdpRequest(&miprq);
+      last_request_mstime = mscounter();
+    }
+    return;
+  }
+
+  if (!batch_prepared)  // prepare the message headers once
+  {
+    memset(&rx_msgs[0], 0, sizeof(rx_msgs));
+    memset(&tx_msgs[0], 0, sizeof(tx_msgs));
+    for (unsigned n = 0; n < UDOIP_BATCH_SIZE; ++n)
+    {
+      rx_iov[n].iov_base = &rx_buf[n][0];
+      rx_iov[n].iov_len  = UDOIP_MAX_RQ_SIZE;
+      rx_msgs[n].msg_hdr.msg_iov = &rx_iov[n];
+      rx_msgs[n].msg_hdr.msg_iovlen = 1;
+      rx_msgs[n].msg_hdr.msg_name = &rx_addr[n];
+
+      tx_iov[n].iov_base = &tx_buf[n][0];
+      tx_msgs[n].msg_hdr.msg_iov = &tx_iov[n];
+      tx_msgs[n].msg_hdr.msg_iovlen = 1;
+      tx_msgs[n].msg_hdr.msg_name = &tx_addr[n];
+      tx_msgs[n].msg_hdr.msg_namelen = sizeof(tx_addr[n]);
+    }
+    batch_prepared = true;
+  }
+
+  while (true)
+  {
+    for (unsigned n = 0; n < UDOIP_BATCH_SIZE; ++n)
+    {
+      rx_msgs[n].msg_hdr.msg_namelen = sizeof(rx_addr[n]);
+    }
+
+    int r = recvmmsg(fdsocket, &rx_msgs[0], UDOIP_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    if (r <= 0)
+    {
+      return;
+    }
+
+    batching = true;
+    tx_count = 0;
+    for (int n = 0; n < r; ++n)
+    {
+      client_addr = rx_addr[n];
+      miprq.srcip = *(uint32_t *)&client_addr.sin_addr;
+      miprq.srcport = ntohs(client_addr.sin_port);
+      miprq.datalen = rx_msgs[n].msg_len;
+      miprq.dataptr = &rx_buf[n][0];
+
+      ProcessUdpRequest(&miprq);
+    }
+    batching = false;
+
+    FlushResponses();
+
+    last_request_mstime = mscounter();
+
+    if (r < UDOIP_BATCH_SIZE)
+    {
+      return;  // no more pending
+    }
+  }
+}
+
+void TUdoIpComm::FlushResponses()
+{
+  unsigned sent = 0;
+  while (sent < tx_count)
+  {
+    int r = sendmmsg(fdsocket, &tx_msgs[sent], tx_count - sent, 0);
+    if (r <= 0)
+    {
+      TRACE("UdoIpComm: sendmmsg error: %i\n", errno);
+      break;
+    }
+    sent += r;
+  }
+  tx_count = 0;
+}
+
+#else
+
+void TUdoIpComm::Run()
+{
+  super::Run();
+}
+
+#endif
+
+int TUdoIpComm::UdpRespondTo(uint32_t adstip, uint16_t adstport, void * srcbuf, unsigned buflen)
+{
+  // for delayed answers, when the client_addr might belong already to another request
+  struct sockaddr_in  dst_addr;
+  memset(&dst_addr, 0, sizeof(dst_addr));
+  dst_addr.sin_family = AF_INET;
+  dst_addr.sin_port = htons(adstport);
+  *(uint32_t *)&dst_addr.sin_addr = adstip;
+
+  int  r = sendto(fdsocket, (char *)srcbuf, buflen, 0, (struct sockaddr*)&dst_addr, sizeof(dst_addr));
+  return r;
+}
@@ -49,19 +49,72 @@ typedef int socklen_t;
 #include <arpa/inet.h>
 #endif
 
+#ifdef WINDOWS
+  #undef  UDOIP_USE_MMSG
+  #define UDOIP_USE_MMSG  0
+#elif !defined(UDOIP_USE_MMSG)
+  #define UDOIP_USE_MMSG  1   // receive / respond in batches with recvmmsg() / sendmmsg()
+#endif
+
+#ifndef UDOIP_BATCH_SIZE
+  #define UDOIP_BATCH_SIZE  16
+#endif
+
 class TUdoIpComm : public TUdoIpCommBase
 {
+private:
+  typedef TUdoIpCommBase super;
+
+public:
+  virtual       ~TUdoIpComm();
+  virtual void  Run();  // processes all the pending requests
+
+  // enables the large payload mode (object 0x0005) with allocating the bigger buffers. It must be called
+  // before Init(), which limits the max_payload_ext to the buffers and builds the answer cache on them,
+  // returns false after Init(). A repeated call frees the buffers of the previous one.
+  bool          SetLargePayload(uint32_t amaxlen, unsigned aanscache_num = UDOIP_ANSCACHE_NUM);
+
+protected: // buffers allocated by the SetLargePayload()
+  TUdoIpSlaveCacheRec *  large_recs = nullptr;
+  uint8_t *             large_cachebuf = nullptr;
+  uint16_t *            large_hash = nullptr;
+  uint8_t *             large_rqbuf = nullptr;
+
+  void          FreeLargePayload();
+
 public: // platform specific
 
   virtual bool  UdpInit();
   virtual int   UdpRecv(); // into mcurq.
   virtual int   UdpRespond(void * srcbuf, unsigned buflen);
 
+  int           UdpRespondTo(uint32_t adstip, uint16_t adstport, void * srcbuf, unsigned buflen);
+
   int   fdsocket = -1;
   struct sockaddr_in   server_addr;
   struct sockaddr_in   client_addr;
   socklen_t client_struct_length = sizeof(client_addr);
   socklen_t server_struct_length = sizeof(server_addr);
+
+#if UDOIP_USE_MMSG
+protected:
+  bool                 batch_prepared = false;
+  bool                 batching = false;  // UdpRespond() collects the answers
+  unsigned             tx_count = 0;
+
+  struct mmsghdr       rx_msgs[UDOIP_BATCH_SIZE];
+  struct iovec         rx_iov[UDOIP_BATCH_SIZE];
+  struct sockaddr_in   rx_addr[UDOIP_BATCH_SIZE];
+  uint8_t              rx_buf[UDOIP_BATCH_SIZE][UDOIP_MAX_RQ_SIZE];
+
+  // the answers are copied, because the answer cache records might be reused within the batch
+  struct mmsghdr       tx_msgs[UDOIP_BATCH_SIZE];
+  struct iovec         tx_iov[UDOIP_BATCH_SIZE];
+  struct sockaddr_in   tx_addr[UDOIP_BATCH_SIZE];
+  uint8_t              tx_buf[UDOIP_BATCH_SIZE][UDOIP_MAX_RQ_SIZE];
+
+  void                 FlushResponses();
+#endif
 };
 
 extern TUdoIpComm g_udoip_comm;
@@ -6,6 +6,12 @@ using namespace std;
 #include "string.h"
 #include "sercomm.h"
 
+#ifndef WIN32
+  #include <poll.h>
+  #include <sys/ioctl.h>
+  #include <linux/serial.h>
+#endif
+
 #define TRACECOMM 0
 
 // Platform dependent functions
@@ -115,6 +121,12 @@ int TSerComm::Write(void * src, unsigned len)
 	}
 }
 
+bool TSerComm::WaitForRx(int atimeout_ms)
+{
+	// not implemented on windows, the caller will poll the Read()
+	return true;
+}
+
 void TSerComm::FlushInput()
 {
   if (!Opened())  return;
@@ -215,6 +227,17 @@ bool TSerComm::Open(string acomport) // full filename on linux
 
 	tcflush(comfd, TCIFLUSH);   /* Discards old data in the rx buffer            */
 
+	if (low_latency)
+	{
+		// shorter receive latency for the FTDI and similar drivers, not supported by all (like CDC-ACM)
+		struct serial_struct serinfo;
+		if (ioctl(comfd, TIOCGSERIAL, &serinfo) == 0)
+		{
+			serinfo.flags |= ASYNC_LOW_LATENCY;
+			ioctl(comfd, TIOCSSERIAL, &serinfo);
+		}
+	}
+
 	return true;
 }
 
@@ -253,6 +276,17 @@ int TSerComm::Write(void * src, unsigned len)
 	}
 }
 
+bool TSerComm::WaitForRx(int atimeout_ms)
+{
+	struct pollfd pfd;
+	pfd.fd = comfd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	int r = poll(&pfd, 1, atimeout_ms);
+	return (r > 0);
+}
+
 void TSerComm::FlushInput()
 {
 	tcflush(comfd, TCIFLUSH);   // Discards old data in the rx buffer
@@ -30,6 +30,7 @@ public:
 #endif
 
 	int     baudrate = 115200;
+	bool    low_latency = true;  // linux: request ASYNC_LOW_LATENCY from the tty driver (if supported)
 
 	string  comport;
 
@@ -41,6 +42,7 @@ public: // platform dependent functions:
 	void  Close();
 	int   Read(void * dst, unsigned len);
 	int   Write(void * src, unsigned len);
+	bool  WaitForRx(int atimeout_ms);  // sleeps until data arrives or the timeout expires
 	void  FlushInput();
 	void  FlushOutput();
 	bool  Opened();